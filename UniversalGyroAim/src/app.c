@@ -1,9 +1,37 @@
 #include "app.h"
 #include "vigem.h"
+#include "uinput.h"
+#include "output.h"
 #include "config.h"
 #include "hidhide.h"
 #include "input.h"
 
+bool App_InitOutputs(void)
+{
+#ifdef _WIN32
+	Output_SetMouseSink(&sendinput_sink);
+	Output_SetPadSink(&vigem_sink);
+	bool initialized = Vigem_Init();
+#else
+	Output_SetMouseSink(&uinput_sink);
+	Output_SetPadSink(&uinput_sink);
+	bool initialized = Uinput_Init(SDL_getenv("UGA_UINPUT_CAPTURE"));
+#endif
+	Output_StartPadThread();
+	return initialized;
+}
+
+void App_ShutdownOutputs(void)
+{
+	Output_StopPadThread();
+	Output_LogPadStats();
+#ifdef _WIN32
+	Vigem_Shutdown();
+#else
+	Uinput_Shutdown();
+#endif
+}
+
 void App_FindAndOpenPhysicalGamepad(void)
 {
 	if (gamepad) return;
@@ -31,15 +59,15 @@ bool App_Reset(void)
 		SDL_CloseGamepad(gamepad);
 		gamepad = NULL;
 	}
-	Vigem_Shutdown();
+	App_ShutdownOutputs();
 
 	gamepad_instance_id = 0;
 	controller_has_led = false;
 	calibration_state = CALIBRATION_IDLE;
 	SetDefaultSettings();
 
-	if (!Vigem_Init()) {
-		SDL_Log("FATAL: Failed to re-initialize ViGEmBus during reset.");
+	if (!App_InitOutputs()) {
+		SDL_Log("FATAL: Failed to re-initialize the virtual output devices during reset.");
 		return false;
 	}
 
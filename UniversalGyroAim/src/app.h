@@ -3,6 +3,8 @@
 
 #include "state.h"
 
+bool App_InitOutputs(void);
+void App_ShutdownOutputs(void);
 void App_FindAndOpenPhysicalGamepad(void);
 bool App_Reset(void);
 
@@ -0,0 +1,605 @@
+#include "bench.h"
+#include "input.h"
+#include "visualizer.h"
+#include "config.h"
+#include "ui.h"
+#include "core/core.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCH_ITERATIONS 1000000
+#define BENCH_RENDER_FRAMES 2000
+
+// The per-frame query chain Input_ProcessAndPassthrough used before the pad state was event-driven.
+static void BuildReportByQuery(SDL_Gamepad* pad, XUSB_REPORT* report)
+{
+	if (SDL_GetGamepadButton(pad, SDL_GAMEPAD_BUTTON_SOUTH)) report->wButtons |= XUSB_GAMEPAD_A;
+	if (SDL_GetGamepadButton(pad, SDL_GAMEPAD_BUTTON_EAST)) report->wButtons |= XUSB_GAMEPAD_B;
+	if (SDL_GetGamepadButton(pad, SDL_GAMEPAD_BUTTON_WEST)) report->wButtons |= XUSB_GAMEPAD_X;
+	if (SDL_GetGamepadButton(pad, SDL_GAMEPAD_BUTTON_NORTH)) report->wButtons |= XUSB_GAMEPAD_Y;
+	if (SDL_GetGamepadButton(pad, SDL_GAMEPAD_BUTTON_LEFT_SHOULDER)) report->wButtons |= XUSB_GAMEPAD_LEFT_SHOULDER;
+	if (SDL_GetGamepadButton(pad, SDL_GAMEPAD_BUTTON_RIGHT_SHOULDER)) report->wButtons |= XUSB_GAMEPAD_RIGHT_SHOULDER;
+	if (SDL_GetGamepadButton(pad, SDL_GAMEPAD_BUTTON_BACK)) report->wButtons |= XUSB_GAMEPAD_BACK;
+	if (SDL_GetGamepadButton(pad, SDL_GAMEPAD_BUTTON_START)) report->wButtons |= XUSB_GAMEPAD_START;
+	if (SDL_GetGamepadButton(pad, SDL_GAMEPAD_BUTTON_LEFT_STICK)) report->wButtons |= XUSB_GAMEPAD_LEFT_THUMB;
+	if (SDL_GetGamepadButton(pad, SDL_GAMEPAD_BUTTON_RIGHT_STICK)) report->wButtons |= XUSB_GAMEPAD_RIGHT_THUMB;
+	if (SDL_GetGamepadButton(pad, SDL_GAMEPAD_BUTTON_DPAD_UP)) report->wButtons |= XUSB_GAMEPAD_DPAD_UP;
+	if (SDL_GetGamepadButton(pad, SDL_GAMEPAD_BUTTON_DPAD_DOWN)) report->wButtons |= XUSB_GAMEPAD_DPAD_DOWN;
+	if (SDL_GetGamepadButton(pad, SDL_GAMEPAD_BUTTON_DPAD_LEFT)) report->wButtons |= XUSB_GAMEPAD_DPAD_LEFT;
+	if (SDL_GetGamepadButton(pad, SDL_GAMEPAD_BUTTON_DPAD_RIGHT)) report->wButtons |= XUSB_GAMEPAD_DPAD_RIGHT;
+	if (SDL_GetGamepadButton(pad, SDL_GAMEPAD_BUTTON_GUIDE)) report->wButtons |= XUSB_GAMEPAD_GUIDE;
+
+	report->bLeftTrigger = (SDL_GetGamepadAxis(pad, SDL_GAMEPAD_AXIS_LEFT_TRIGGER) * 255) / 32767;
+	report->bRightTrigger = (SDL_GetGamepadAxis(pad, SDL_GAMEPAD_AXIS_RIGHT_TRIGGER) * 255) / 32767;
+	report->sThumbLX = SDL_GetGamepadAxis(pad, SDL_GAMEPAD_AXIS_LEFTX);
+	report->sThumbLY = SDL_GetGamepadAxis(pad, SDL_GAMEPAD_AXIS_LEFTY);
+	report->sThumbRX = SDL_GetGamepadAxis(pad, SDL_GAMEPAD_AXIS_RIGHTX);
+	report->sThumbRY = SDL_GetGamepadAxis(pad, SDL_GAMEPAD_AXIS_RIGHTY);
+}
+
+static void BuildReportFromState(const PadState* state, XUSB_REPORT* report)
+{
+	report->wButtons = Input_MapButtonsToXusb(state->buttons);
+	report->bLeftTrigger = (state->axes[SDL_GAMEPAD_AXIS_LEFT_TRIGGER] * 255) / 32767;
+	report->bRightTrigger = (state->axes[SDL_GAMEPAD_AXIS_RIGHT_TRIGGER] * 255) / 32767;
+	report->sThumbLX = state->axes[SDL_GAMEPAD_AXIS_LEFTX];
+	report->sThumbLY = state->axes[SDL_GAMEPAD_AXIS_LEFTY];
+	report->sThumbRX = state->axes[SDL_GAMEPAD_AXIS_RIGHTX];
+	report->sThumbRY = state->axes[SDL_GAMEPAD_AXIS_RIGHTY];
+}
+
+static double NsPerIteration(Uint64 start, Uint64 end)
+{
+	return (double)(end - start) * 1e9 / SDL_GetPerformanceFrequency() / BENCH_ITERATIONS;
+}
+
+// A virtual gamepad stands in for the physical one so benchmarks go through real SDL device state.
+static SDL_Gamepad* OpenBenchPad(SDL_JoystickID* id)
+{
+	SDL_VirtualJoystickDesc desc;
+	SDL_INIT_INTERFACE(&desc);
+	desc.type = SDL_JOYSTICK_TYPE_GAMEPAD;
+	desc.naxes = SDL_GAMEPAD_AXIS_COUNT;
+	desc.nbuttons = SDL_GAMEPAD_BUTTON_COUNT;
+	desc.name = "Universal Gyro Aim Benchmark Pad";
+
+	*id = SDL_AttachVirtualJoystick(&desc);
+	SDL_Gamepad* pad = *id ? SDL_OpenGamepad(*id) : NULL;
+	if (!pad) {
+		SDL_Log("Error: Could not create benchmark gamepad: %s", SDL_GetError());
+		if (*id) SDL_DetachVirtualJoystick(*id);
+		*id = 0;
+	}
+	return pad;
+}
+
+bool Bench_RunInputMapping(void)
+{
+	SDL_JoystickID id;
+	SDL_Gamepad* pad = OpenBenchPad(&id);
+	if (!pad) return false;
+
+	// A typical aiming frame: a few buttons held, sticks and one trigger deflected.
+	const SDL_GamepadButton held_buttons[] = { SDL_GAMEPAD_BUTTON_SOUTH, SDL_GAMEPAD_BUTTON_LEFT_SHOULDER, SDL_GAMEPAD_BUTTON_DPAD_UP };
+	PadState state = { 0 };
+	SDL_Joystick* joystick = SDL_GetGamepadJoystick(pad);
+	for (size_t i = 0; i < SDL_arraysize(held_buttons); ++i) {
+		SDL_SetJoystickVirtualButton(joystick, held_buttons[i], true);
+		state.buttons |= 1u << held_buttons[i];
+	}
+	const Sint16 axis_values[SDL_GAMEPAD_AXIS_COUNT] = { 12000, -8000, 3000, -20000, 0, 32767 };
+	for (int i = 0; i < SDL_GAMEPAD_AXIS_COUNT; ++i) {
+		SDL_SetJoystickVirtualAxis(joystick, i, axis_values[i]);
+		state.axes[i] = axis_values[i];
+	}
+	SDL_UpdateJoysticks();
+
+	volatile Uint16 checksum = 0;
+	XUSB_REPORT report;
+
+	Uint64 start = SDL_GetPerformanceCounter();
+	for (int i = 0; i < BENCH_ITERATIONS; ++i) {
+		SDL_zero(report);
+		BuildReportByQuery(pad, &report);
+		checksum ^= report.wButtons ^ report.sThumbRX;
+	}
+	Uint64 query_end = SDL_GetPerformanceCounter();
+	for (int i = 0; i < BENCH_ITERATIONS; ++i) {
+		SDL_zero(report);
+		BuildReportFromState(&state, &report);
+		checksum ^= report.wButtons ^ report.sThumbRX;
+	}
+	Uint64 state_end = SDL_GetPerformanceCounter();
+
+	double query_ns = NsPerIteration(start, query_end);
+	double state_ns = NsPerIteration(query_end, state_end);
+	SDL_Log("Input mapping benchmark (%d reports): SDL queries %.1f ns/report, event-driven state %.1f ns/report (%.1fx).",
+		BENCH_ITERATIONS, query_ns, state_ns, state_ns > 0.0 ? query_ns / state_ns : 0.0);
+
+	SDL_CloseGamepad(pad);
+	SDL_DetachVirtualJoystick(id);
+	return true;
+}
+
+// The visualizer as UI_Render drew it before the static layer was cached: one call per point or scanline.
+static int immediate_draw_calls = 0;
+
+static void DrawFilledCircleImmediate(SDL_Renderer* renderer, int x, int y, int radius)
+{
+	int offsetx, offsety, d;
+	offsetx = 0; offsety = radius; d = radius - 1;
+	while (offsety >= offsetx) {
+		SDL_RenderLine(renderer, x - offsety, y + offsetx, x + offsety, y + offsetx);
+		SDL_RenderLine(renderer, x - offsetx, y + offsety, x + offsetx, y + offsety);
+		SDL_RenderLine(renderer, x - offsetx, y - offsety, x + offsetx, y - offsety);
+		SDL_RenderLine(renderer, x - offsety, y - offsetx, x + offsety, y - offsetx);
+		immediate_draw_calls += 4;
+		if (d >= 2 * offsetx) {
+			d -= 2 * offsetx + 1; offsetx++;
+		}
+		else if (d < 2 * (radius - offsety)) {
+			d += 2 * offsety - 1; offsety--;
+		}
+		else { d += 2 * (offsety - offsetx - 1); offsety--; offsetx++; }
+	}
+}
+
+static void DrawCircleImmediate(SDL_Renderer* renderer, int centreX, int centreY, int radius)
+{
+	const int32_t diameter = (radius * 2);
+	int32_t x = (radius - 1); int32_t y = 0; int32_t tx = 1; int32_t ty = 1; int32_t error = (tx - diameter);
+	while (x >= y) {
+		SDL_RenderPoint(renderer, centreX + x, centreY - y); SDL_RenderPoint(renderer, centreX + x, centreY + y);
+		SDL_RenderPoint(renderer, centreX - x, centreY - y); SDL_RenderPoint(renderer, centreX - x, centreY + y);
+		SDL_RenderPoint(renderer, centreX + y, centreY - x); SDL_RenderPoint(renderer, centreX + y, centreY + x);
+		SDL_RenderPoint(renderer, centreX - y, centreY - x); SDL_RenderPoint(renderer, centreX - y, centreY + x);
+		immediate_draw_calls += 8;
+		if (error <= 0) { ++y; error += ty; ty += 2; }
+		if (error > 0) { --x; tx += 2; error += (tx - diameter); }
+	}
+}
+
+static void DrawVisualizerImmediate(SDL_Renderer* renderer, int cX, int cY, const AppSettings* s, int dx, int dy)
+{
+	SDL_SetRenderDrawColor(renderer, s->flick_stick_enabled ? 255 : 100, 80, 80, 255);
+	DrawCircleImmediate(renderer, cX, cY, VISUALIZER_OUTER_RADIUS);
+	if (!s->mouse_mode && s->anti_deathzone > 0.0f) {
+		SDL_SetRenderDrawColor(renderer, 60, 60, 80, 255);
+		DrawFilledCircleImmediate(renderer, cX, cY, (int)(VISUALIZER_OUTER_RADIUS * (s->anti_deathzone / 100.0f)));
+	}
+	SDL_SetRenderDrawColor(renderer, 255, 80, 80, 255);
+	DrawFilledCircleImmediate(renderer, cX + dx, cY + dy, VISUALIZER_DOT_RADIUS);
+}
+
+// Dot position for a frame: a slow sweep around the ring, like steady aiming.
+static void BenchDotOffset(int frame, int* dx, int* dy)
+{
+	float angle = frame * 0.05f;
+	*dx = (int)(cosf(angle) * VISUALIZER_OUTER_RADIUS * 0.6f);
+	*dy = (int)(sinf(angle) * VISUALIZER_OUTER_RADIUS * 0.6f);
+}
+
+static void ClearBenchFrame(SDL_Renderer* renderer)
+{
+	SDL_SetRenderDrawColor(renderer, 20, 20, 30, 255);
+	SDL_RenderClear(renderer);
+}
+
+bool Bench_RunRender(void)
+{
+	// The software renderer needs no display, so this runs anywhere. GPU renderers batch calls rather than
+	// rasterizing each one on the CPU, but their per-call overhead scales the same way with the call count.
+	SDL_Surface* surface = SDL_CreateSurface(420, 195, SDL_PIXELFORMAT_RGBA8888);
+	SDL_Renderer* bench_renderer = surface ? SDL_CreateSoftwareRenderer(surface) : NULL;
+	if (!bench_renderer) {
+		SDL_Log("Error: Could not create benchmark renderer: %s", SDL_GetError());
+		if (surface) SDL_DestroySurface(surface);
+		return false;
+	}
+
+	AppSettings s = { 0 };
+	s.anti_deathzone = 30.0f;
+	const int cX = 420 - 55, cY = 55;
+	int dx, dy;
+
+	immediate_draw_calls = 0;
+	Uint64 start = SDL_GetPerformanceCounter();
+	for (int frame = 0; frame < BENCH_RENDER_FRAMES; ++frame) {
+		ClearBenchFrame(bench_renderer);
+		BenchDotOffset(frame, &dx, &dy);
+		DrawVisualizerImmediate(bench_renderer, cX, cY, &s, dx, dy);
+		SDL_FlushRenderer(bench_renderer);
+	}
+	Uint64 immediate_end = SDL_GetPerformanceCounter();
+
+	// Build the cached layer up front; in the app this happens only when the ring's settings change.
+	Visualizer_Draw(bench_renderer, (float)cX, (float)cY, &s, 0.0f, 0.0f, true);
+	SDL_FlushRenderer(bench_renderer);
+
+	int cached_draw_calls = 0;
+	Uint64 cached_start = SDL_GetPerformanceCounter();
+	for (int frame = 0; frame < BENCH_RENDER_FRAMES; ++frame) {
+		ClearBenchFrame(bench_renderer);
+		BenchDotOffset(frame, &dx, &dy);
+		cached_draw_calls += Visualizer_Draw(bench_renderer, (float)cX, (float)cY, &s, (float)dx, (float)dy, true);
+		SDL_FlushRenderer(bench_renderer);
+	}
+	Uint64 cached_end = SDL_GetPerformanceCounter();
+
+	double frequency = (double)SDL_GetPerformanceFrequency();
+	double immediate_us = (double)(immediate_end - start) * 1e6 / frequency / BENCH_RENDER_FRAMES;
+	double cached_us = (double)(cached_end - cached_start) * 1e6 / frequency / BENCH_RENDER_FRAMES;
+	SDL_Log("Visualizer render benchmark (%d frames, software renderer): per-pixel %.1f draw calls / %.1f us per frame, cached layer %.1f draw calls / %.1f us per frame (%.1fx).",
+		BENCH_RENDER_FRAMES, (double)immediate_draw_calls / BENCH_RENDER_FRAMES, immediate_us,
+		(double)cached_draw_calls / BENCH_RENDER_FRAMES, cached_us, cached_us > 0.0 ? immediate_us / cached_us : 0.0);
+
+	Visualizer_Destroy();
+	SDL_DestroyRenderer(bench_renderer);
+	SDL_DestroySurface(surface);
+	return true;
+}
+
+// --- Stage suite: each pipeline stage timed on its own, reported as JSON so two builds can be diffed ---
+#define BENCH_SUITE_RUNS 21 // Timed runs per stage; the statistics are across runs
+#define BENCH_SUITE_RUN_NS 20000000ull // Target length of one timed run
+#define BENCH_SUITE_WARMUP_NS 200000000ull // Untimed repetitions before the first timed run
+#define BENCH_SUITE_INPUTS 1024 // Precomputed inputs each stage cycles through; a power of two
+#define BENCH_SUITE_SAMPLE_DT 0.001f // 1 kHz gyro
+#define BENCH_SUITE_MAX_STEP 2 // Counts per injected event, so the splitting is exercised
+#define BENCH_SUITE_PROFILE "bench_suite.ini"
+
+typedef struct {
+	const char* name;
+	const char* description;
+	bool (*setup)(void); // Optional; false skips the stage
+	void (*run)(Uint64 iterations);
+	void (*teardown)(void); // Optional
+} BenchStage;
+
+typedef struct {
+	Uint64 iterations; // Per timed run
+	double ns_per_op[BENCH_SUITE_RUNS]; // Sorted ascending
+	double mean_ns;
+	double stddev_ns;
+} BenchStageResult;
+
+static float bench_gyro[BENCH_SUITE_INPUTS][3];
+static Sint16 bench_stick[BENCH_SUITE_INPUTS][2];
+static float bench_mouse_delta[BENCH_SUITE_INPUTS][2];
+static CoreConfig bench_config;
+static volatile float bench_sink; // Every stage folds its results in here so none of the work is optimized away
+
+static SDL_Gamepad* bench_pad = NULL;
+static SDL_JoystickID bench_pad_id = 0;
+static SDL_Surface* bench_surface = NULL;
+static char bench_profile_path[MAX_PATH]; // Set while the load_settings stage owns its profile file
+
+// Inputs shaped like real aiming: smooth gyro motion, a stick circling at full deflection that is released
+// every 128 samples (so flicks start as well as rotate), and mouse deltas of a few counts per tick.
+static void FillSuiteInputs(void)
+{
+	for (int i = 0; i < BENCH_SUITE_INPUTS; ++i) {
+		bench_gyro[i][0] = sinf(i * 0.011f) * 1.5f + 0.02f;
+		bench_gyro[i][1] = cosf(i * 0.017f) * 2.5f - 0.01f;
+		bench_gyro[i][2] = sinf(i * 0.005f) * 0.3f;
+
+		float angle = i * (2.0f * SDL_PI_F / 64.0f);
+		bool released = (i % 128) == 0;
+		bench_stick[i][0] = released ? 0 : (Sint16)(cosf(angle) * 32000.0f);
+		bench_stick[i][1] = released ? 0 : (Sint16)(sinf(angle) * 32000.0f);
+
+		bench_mouse_delta[i][0] = sinf(i * 0.07f) * 6.3f;
+		bench_mouse_delta[i][1] = cosf(i * 0.05f) * 2.7f;
+	}
+
+	AppSettings s;
+	SDL_zero(s);
+	s.gyro_calibration_offset[0] = 0.012f; s.gyro_calibration_offset[1] = -0.004f; s.gyro_calibration_offset[2] = 0.007f;
+	s.mouse_sensitivity = 800.0f;
+	s.sensitivity = 1.0f;
+	s.flick_stick_calibration_value = 5000.0f;
+	BuildCoreConfig(&s, &bench_config);
+}
+
+static void RunCalibrationScaling(Uint64 iterations)
+{
+	float delta_x = 0.0f, delta_y = 0.0f, calibrated[3];
+	for (Uint64 i = 0; i < iterations; ++i) {
+		Core_ApplyGyroOffset(&bench_config, bench_gyro[i & (BENCH_SUITE_INPUTS - 1)], calibrated);
+		Core_IntegrateGyro(&bench_config, calibrated, BENCH_SUITE_SAMPLE_DT, &delta_x, &delta_y);
+	}
+	bench_sink += delta_x + delta_y;
+}
+
+static void RunFlickStick(Uint64 iterations)
+{
+	CoreFlickStick flick = { 0 };
+	float turned = 0.0f;
+	for (Uint64 i = 0; i < iterations; ++i) {
+		const Sint16* stick = bench_stick[i & (BENCH_SUITE_INPUTS - 1)];
+		turned += Core_FlickStickUpdate(&flick, &bench_config, stick[0], stick[1]);
+	}
+	bench_sink += turned;
+}
+
+// Joystick mode with the gyro mixed in, through the same adapter the input thread calls.
+static bool SetupReportBuild(void)
+{
+	bench_pad = OpenBenchPad(&bench_pad_id);
+	if (!bench_pad) return false;
+	gamepad = bench_pad;
+	settings.mouse_mode = false;
+	settings.flick_stick_enabled = false;
+	settings.always_on_gyro = true;
+	settings.sensitivity = 1.0f;
+	calibration_state = CALIBRATION_IDLE;
+	SDL_zero(pad_state);
+	pad_state.buttons = (1u << SDL_GAMEPAD_BUTTON_SOUTH) | (1u << SDL_GAMEPAD_BUTTON_LEFT_SHOULDER);
+	pad_state.axes[SDL_GAMEPAD_AXIS_LEFTX] = 12000;
+	pad_state.axes[SDL_GAMEPAD_AXIS_LEFTY] = -8000;
+	pad_state.axes[SDL_GAMEPAD_AXIS_RIGHT_TRIGGER] = 32767;
+	return true;
+}
+
+static void RunReportBuild(Uint64 iterations)
+{
+	XUSB_REPORT report;
+	Sint32 checksum = 0;
+	for (Uint64 i = 0; i < iterations; ++i) {
+		Uint64 input = i & (BENCH_SUITE_INPUTS - 1);
+		// Quarter deflection, so the stick stays under the gyro takeover threshold most of the time.
+		pad_state.axes[SDL_GAMEPAD_AXIS_RIGHTX] = bench_stick[input][0] / 4;
+		pad_state.axes[SDL_GAMEPAD_AXIS_RIGHTY] = bench_stick[input][1] / 4;
+		gyro_data[0] = bench_gyro[input][0]; gyro_data[1] = bench_gyro[input][1];
+		SDL_zero(report);
+		Input_ProcessAndPassthrough(&report);
+		checksum += report.wButtons + report.sThumbRX + report.sThumbRY;
+	}
+	bench_sink += (float)checksum;
+}
+
+static void TeardownPad(void)
+{
+	gamepad = NULL;
+	if (bench_pad) SDL_CloseGamepad(bench_pad);
+	if (bench_pad_id) SDL_DetachVirtualJoystick(bench_pad_id);
+	bench_pad = NULL; bench_pad_id = 0;
+}
+
+// The mouse thread's per-tick work short of the output sink: carry the fraction, split into sub-steps.
+static void RunMouseAccumulateSplit(Uint64 iterations)
+{
+	CoreSubCount accumulator = { 0 };
+	MouseMove moves[MOUSE_INPUT_BATCH_SIZE];
+	Sint32 total = 0;
+	for (Uint64 i = 0; i < iterations; ++i) {
+		const float* delta = bench_mouse_delta[i & (BENCH_SUITE_INPUTS - 1)];
+		Sint32 move_x, move_y;
+		Core_SubCountAdd(&accumulator, delta[0], delta[1], &move_x, &move_y);
+		if (move_x == 0 && move_y == 0) continue;
+		Sint32 steps = Core_MouseStepCount(move_x, move_y, BENCH_SUITE_MAX_STEP);
+		for (Sint32 step = 0; step < steps; ++step) {
+			MouseMove* move = &moves[step % MOUSE_INPUT_BATCH_SIZE];
+			Core_MouseStep(move_x, move_y, steps, step, &move->dx, &move->dy);
+			total += move->dx - move->dy;
+		}
+	}
+	bench_sink += (float)total;
+}
+
+// A profile as SaveSettings writes it, loaded from the profiles directory like a profile switch.
+// Profiles only load from the profiles directory, so the stage writes its own there and deletes it afterwards. A file
+// of that name it did not create is never overwritten or removed; the stage is skipped instead.
+static bool SetupLoadSettings(void)
+{
+	char path[MAX_PATH];
+	if (!GetProfilesDir(path, MAX_PATH) || SDL_strlcat(path, "/" BENCH_SUITE_PROFILE, MAX_PATH) >= MAX_PATH) return false;
+	if (SDL_GetPathInfo(path, NULL)) {
+		SDL_Log("Skipping load_settings: %s already exists and is not the benchmark's to overwrite.", path);
+		return false;
+	}
+
+	SetDefaultSettings();
+	settings.selected_button = SDL_GAMEPAD_BUTTON_LEFT_SHOULDER;
+	SaveSettings(BENCH_SUITE_PROFILE);
+	if (SDL_GetPathInfo(path, NULL)) strcpy_s(bench_profile_path, sizeof(bench_profile_path), path);
+	if (!LoadSettings(BENCH_SUITE_PROFILE)) return false; // The teardown still runs and removes the file
+	SDL_SetLogPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_WARN); // LoadSettings logs twice per call
+	return true;
+}
+
+static void RunLoadSettings(Uint64 iterations)
+{
+	for (Uint64 i = 0; i < iterations; ++i) {
+		LoadSettings(BENCH_SUITE_PROFILE);
+	}
+	bench_sink += settings.mouse_sensitivity;
+}
+
+static void TeardownLoadSettings(void)
+{
+	SDL_ResetLogPriorities();
+	if (bench_profile_path[0]) {
+		SDL_RemovePath(bench_profile_path);
+		bench_profile_path[0] = '\0';
+	}
+}
+
+// The main menu with the visualizer, redrawn in full every frame on an offscreen software renderer.
+static bool SetupMenuRender(void)
+{
+	bench_surface = SDL_CreateSurface(420, 235, SDL_PIXELFORMAT_RGBA8888);
+	renderer = bench_surface ? SDL_CreateSoftwareRenderer(bench_surface) : NULL;
+	if (!renderer || !SetupReportBuild()) {
+		SDL_Log("Error: Could not create benchmark renderer: %s", SDL_GetError());
+		return false;
+	}
+#ifdef _WIN32
+	vigem_found = true; // Otherwise the menu gives way to the driver error
+#else
+	uinput_found = true;
+#endif
+	gyro_data[0] = 0.4f; gyro_data[1] = -0.6f;
+	Input_LockState();
+	Input_UnlockState(); // Publishes the connected pad to the UI's snapshot
+	return true;
+}
+
+static void RunMenuRender(Uint64 iterations)
+{
+	for (Uint64 i = 0; i < iterations; ++i) {
+		SDL_SetAtomicInt(&force_one_render, 1);
+		UI_Render();
+	}
+}
+
+static void TeardownMenuRender(void)
+{
+	Visualizer_Destroy();
+	if (renderer) SDL_DestroyRenderer(renderer);
+	renderer = NULL;
+	if (bench_surface) SDL_DestroySurface(bench_surface);
+	bench_surface = NULL;
+#ifdef _WIN32
+	vigem_found = false;
+#else
+	uinput_found = false;
+#endif
+	TeardownPad();
+}
+
+static const BenchStage bench_stages[] = {
+	{ "calibration_scaling", "Gyro offset and scaling to mouse counts, per sample", NULL, RunCalibrationScaling, NULL },
+	{ "flick_stick", "Flick stick angle, wrap and turn, per stick update", NULL, RunFlickStick, NULL },
+	{ "report_build", "XUSB_REPORT from the pad state with gyro mixed into the right stick, per report", SetupReportBuild, RunReportBuild, TeardownPad },
+	{ "mouse_accumulate_split", "Sub-count accumulation and event splitting, per mouse tick", NULL, RunMouseAccumulateSplit, NULL },
+	{ "load_settings", "LoadSettings of a saved profile, per load", SetupLoadSettings, RunLoadSettings, TeardownLoadSettings },
+	{ "menu_render", "Main menu and visualizer redrawn on the software renderer, per frame", SetupMenuRender, RunMenuRender, TeardownMenuRender }
+};
+
+static Uint64 TimeStageRun(const BenchStage* stage, Uint64 iterations)
+{
+	Uint64 start = SDL_GetTicksNS();
+	stage->run(iterations);
+	return SDL_GetTicksNS() - start;
+}
+
+static int CompareDoubles(const void* a, const void* b)
+{
+	double x = *(const double*)a, y = *(const double*)b;
+	return (x > y) - (x < y);
+}
+
+// Sizes a run to BENCH_SUITE_RUN_NS, warms up, then times BENCH_SUITE_RUNS runs.
+static void MeasureStage(const BenchStage* stage, BenchStageResult* result)
+{
+	Uint64 iterations = 1, elapsed;
+	while ((elapsed = TimeStageRun(stage, iterations)) < BENCH_SUITE_RUN_NS / 16) iterations *= 2;
+	iterations = SDL_max(iterations * BENCH_SUITE_RUN_NS / SDL_max(elapsed, 1), 1);
+
+	Uint64 warmup_start = SDL_GetTicksNS();
+	while (SDL_GetTicksNS() - warmup_start < BENCH_SUITE_WARMUP_NS) TimeStageRun(stage, iterations);
+
+	result->iterations = iterations;
+	double sum = 0.0;
+	for (int run = 0; run < BENCH_SUITE_RUNS; ++run) {
+		result->ns_per_op[run] = (double)TimeStageRun(stage, iterations) / iterations;
+		sum += result->ns_per_op[run];
+	}
+	qsort(result->ns_per_op, BENCH_SUITE_RUNS, sizeof(double), CompareDoubles);
+	result->mean_ns = sum / BENCH_SUITE_RUNS;
+	double variance = 0.0;
+	for (int run = 0; run < BENCH_SUITE_RUNS; ++run) {
+		variance += (result->ns_per_op[run] - result->mean_ns) * (result->ns_per_op[run] - result->mean_ns);
+	}
+	result->stddev_ns = sqrt(variance / (BENCH_SUITE_RUNS - 1));
+}
+
+static void DescribeCompiler(char* buffer, size_t size)
+{
+#if defined(__clang__)
+	SDL_snprintf(buffer, size, "clang %s", __clang_version__);
+#elif defined(_MSC_VER)
+	SDL_snprintf(buffer, size, "msvc %d", _MSC_FULL_VER);
+#elif defined(__GNUC__)
+	SDL_snprintf(buffer, size, "gcc %s", __VERSION__);
+#else
+	SDL_snprintf(buffer, size, "unknown");
+#endif
+}
+
+// One entry of the "stages" array; a NULL result marks a stage whose setup failed.
+static void WriteStageJson(FILE* file, const BenchStage* stage, const BenchStageResult* result, bool last)
+{
+	fprintf(file, "    {\n");
+	fprintf(file, "      \"name\": \"%s\",\n", stage->name);
+	fprintf(file, "      \"description\": \"%s\",\n", stage->description);
+	if (!result) {
+		fprintf(file, "      \"skipped\": true\n");
+		fprintf(file, "    }%s\n", last ? "" : ",");
+		return;
+	}
+	const double* ns = result->ns_per_op;
+	double median = ns[BENCH_SUITE_RUNS / 2];
+	fprintf(file, "      \"iterations_per_run\": %llu,\n", (unsigned long long)result->iterations);
+	fprintf(file, "      \"ns_per_op\": { \"min\": %.3f, \"median\": %.3f, \"mean\": %.3f, \"stddev\": %.3f, \"p90\": %.3f, \"max\": %.3f },\n",
+		ns[0], median, result->mean_ns, result->stddev_ns, ns[BENCH_SUITE_RUNS * 9 / 10], ns[BENCH_SUITE_RUNS - 1]);
+	fprintf(file, "      \"ops_per_sec\": %.0f\n", median > 0.0 ? 1e9 / median : 0.0);
+	fprintf(file, "    }%s\n", last ? "" : ",");
+}
+
+bool Bench_RunSuite(const char* output_path)
+{
+	FILE* file = stdout;
+	if (SDL_strcmp(output_path, "-") != 0 && (fopen_s(&file, output_path, "w") != 0 || !file)) {
+		SDL_Log("Error: Could not open %s for writing.", output_path);
+		return false;
+	}
+
+	char compiler[128];
+	DescribeCompiler(compiler, sizeof(compiler));
+	FillSuiteInputs();
+	fprintf(file, "{\n");
+	fprintf(file, "  \"suite\": \"UniversalGyroAim stages\",\n");
+	fprintf(file, "  \"platform\": \"%s\",\n", SDL_GetPlatform());
+	fprintf(file, "  \"compiler\": \"%s\",\n", compiler);
+#ifdef NDEBUG
+	fprintf(file, "  \"build\": \"release\",\n");
+#else
+	fprintf(file, "  \"build\": \"debug\",\n");
+#endif
+	fprintf(file, "  \"runs_per_stage\": %d,\n", BENCH_SUITE_RUNS);
+	fprintf(file, "  \"run_target_ns\": %llu,\n", (unsigned long long)BENCH_SUITE_RUN_NS);
+	fprintf(file, "  \"warmup_ns\": %llu,\n", (unsigned long long)BENCH_SUITE_WARMUP_NS);
+	fprintf(file, "  \"stages\": [\n");
+
+	bool all_ran = true;
+	const int stage_count = (int)SDL_arraysize(bench_stages);
+	for (int i = 0; i < stage_count; ++i) {
+		const BenchStage* stage = &bench_stages[i];
+		BenchStageResult result;
+		bool ready = !stage->setup || stage->setup();
+		if (ready) {
+			MeasureStage(stage, &result);
+		}
+		if (stage->teardown) stage->teardown();
+		if (!ready) {
+			SDL_Log("Warning: Skipped benchmark stage %s.", stage->name);
+			all_ran = false;
+		}
+		else {
+			double median = result.ns_per_op[BENCH_SUITE_RUNS / 2];
+			SDL_Log("%-24s %12.1f ns/op median (min %.1f, stddev %.1f), %14.0f ops/s", stage->name,
+				median, result.ns_per_op[0], result.stddev_ns, median > 0.0 ? 1e9 / median : 0.0);
+		}
+		WriteStageJson(file, stage, ready ? &result : NULL, i == stage_count - 1);
+	}
+	fprintf(file, "  ]\n}\n");
+
+	if (file != stdout) {
+		fclose(file);
+		SDL_Log("Benchmark results written to %s.", output_path);
+	}
+	return all_ran;
+}
\ No newline at end of file
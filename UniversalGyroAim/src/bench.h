@@ -0,0 +1,14 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "state.h"
+
+// Times building the passthrough buttons and axes by per-frame SDL queries against the event-driven pad state.
+bool Bench_RunInputMapping(void);
+// Times the gyro visualizer drawn per pixel against the cached layer plus dot geometry, on an offscreen renderer.
+bool Bench_RunRender(void);
+// Times every pipeline stage in isolation and writes ns/op and ops/s statistics as JSON ("-" = stdout).
+// Returns false if the file could not be written or a stage could not be set up.
+bool Bench_RunSuite(const char* output_path);
+
+#endif
\ No newline at end of file
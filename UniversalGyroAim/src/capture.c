@@ -0,0 +1,772 @@
+#include "capture.h"
+#include "wakeup.h"
+#include "clock.h"
+#include "config.h"
+#include <stdio.h>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define CAPTURE_FILE_MAGIC "UGACAPT"
+#define CAPTURE_CHUNK_MAGIC 0x4B434755u // "UGCK"
+#define CAPTURE_INDEX_MAGIC 0x58494755u // "UGIX"
+#define CAPTURE_FOOTER_MAGIC 0x54464755u // "UGFT"
+#define CAPTURE_HEADER_BYTES (8 + 4 + 4 + 8 + 64)
+#define CAPTURE_CHUNK_HEADER_BYTES 32
+#define CAPTURE_INDEX_ENTRY_BYTES 32
+#define CAPTURE_FOOTER_BYTES 16
+#define CAPTURE_MAX_RECORD_BYTES 48 // Worst case encoded size of one record
+#define CAPTURE_MAX_CHUNKS 65536
+
+// Chunk-local previous values the deltas are taken against; reset at every chunk start.
+typedef struct {
+	Uint64 timestamp_us;
+	Sint64 sensor_lag_us; // Event timestamp minus sensor timestamp; steady, so its deltas stay within a byte
+	Sint32 gyro[3];
+	XUSB_REPORT pad;
+} CaptureCodecState;
+
+// --- Fields present in a pad record; the rest repeat the previous pad record of the chunk ---
+#define CAPTURE_PAD_BUTTONS       0x01
+#define CAPTURE_PAD_LEFT_TRIGGER  0x02
+#define CAPTURE_PAD_RIGHT_TRIGGER 0x04
+#define CAPTURE_PAD_THUMB_LX      0x08
+#define CAPTURE_PAD_THUMB_LY      0x10
+#define CAPTURE_PAD_THUMB_RX      0x20
+#define CAPTURE_PAD_THUMB_RY      0x40
+
+// --- Writer state, owned by the writer thread between Capture_Start and Capture_Stop ---
+static FILE* capture_file = NULL;
+static Uint64 capture_file_offset = 0;
+static Uint8 chunk_payload[CAPTURE_CHUNK_BYTES + CAPTURE_MAX_RECORD_BYTES];
+static Uint32 chunk_payload_bytes = 0;
+static CaptureChunkInfo chunk_info;
+static CaptureCodecState writer_codec;
+static CaptureChunkInfo* chunk_index = NULL;
+static int chunk_count = 0;
+static int chunk_index_capacity = 0;
+static bool chunk_index_incomplete = false; // A chunk could not be indexed; the file is closed without an index
+static Uint64 records_written = 0;
+static Uint64 capture_start_ns = 0;
+static bool capture_write_failed = false;
+static bool capture_blocks_when_full = false;
+
+// --- Reader state ---
+static const Uint8* reader_data = NULL; // The whole file, mapped read-only
+static size_t reader_size = 0;
+static Uint64 reader_start_ns = 0;
+static CaptureChunkInfo* reader_chunks = NULL;
+static int reader_chunk_count = 0;
+static int reader_chunk = 0;
+static size_t reader_pos = 0; // Within the current chunk's payload
+static size_t reader_chunk_end = 0;
+static Uint32 reader_records_left = 0;
+static CaptureCodecState reader_codec;
+
+// --- Little-endian encoding ---
+static void PutU32(Uint8* out, Uint32 value)
+{
+	for (int i = 0; i < 4; ++i) out[i] = (Uint8)(value >> (8 * i));
+}
+
+static void PutU64(Uint8* out, Uint64 value)
+{
+	for (int i = 0; i < 8; ++i) out[i] = (Uint8)(value >> (8 * i));
+}
+
+static Uint32 GetU32(const Uint8* in)
+{
+	Uint32 value = 0;
+	for (int i = 0; i < 4; ++i) value |= (Uint32)in[i] << (8 * i);
+	return value;
+}
+
+static Uint64 GetU64(const Uint8* in)
+{
+	Uint64 value = 0;
+	for (int i = 0; i < 8; ++i) value |= (Uint64)in[i] << (8 * i);
+	return value;
+}
+
+static int PutVarint(Uint8* out, Uint64 value)
+{
+	int length = 0;
+	while (value >= 0x80) {
+		out[length++] = (Uint8)(value | 0x80);
+		value >>= 7;
+	}
+	out[length++] = (Uint8)value;
+	return length;
+}
+
+// Zigzag maps small magnitudes of either sign to small unsigned values: 0, -1, 1, -2 -> 0, 1, 2, 3.
+static int PutSignedVarint(Uint8* out, Sint64 value)
+{
+	return PutVarint(out, ((Uint64)value << 1) ^ (Uint64)(value >> 63));
+}
+
+static bool GetVarint(Uint64* value)
+{
+	Uint64 result = 0;
+	for (int shift = 0; shift < 64; shift += 7) {
+		if (reader_pos >= reader_chunk_end) return false;
+		Uint8 byte = reader_data[reader_pos++];
+		result |= (Uint64)(byte & 0x7F) << shift;
+		if (!(byte & 0x80)) {
+			*value = result;
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool GetSignedVarint(Sint64* value)
+{
+	Uint64 raw;
+	if (!GetVarint(&raw)) return false;
+	*value = (Sint64)(raw >> 1) ^ -(Sint64)(raw & 1);
+	return true;
+}
+
+static bool GetByte(Uint8* value)
+{
+	if (reader_pos >= reader_chunk_end) return false;
+	*value = reader_data[reader_pos++];
+	return true;
+}
+
+static Sint32 QuantizeGyro(float value)
+{
+	float scaled = value * CAPTURE_GYRO_SCALE;
+	scaled = CLAMP(scaled, -2.0e9f, 2.0e9f);
+	return (Sint32)(scaled + (scaled >= 0.0f ? 0.5f : -0.5f));
+}
+
+// --- Producers ---
+static void PushRecord(CaptureProducer producer, const CaptureRecord* record)
+{
+	CaptureRing* ring = capture_rings[producer];
+	if (!ring) return;
+
+	Uint32 head = SDL_GetAtomicU32(&ring->head);
+	Uint32 tail = SDL_GetAtomicU32(&ring->tail);
+	while (head - tail >= CAPTURE_RING_CAPACITY) {
+		if (!capture_blocks_when_full) {
+			SDL_AddAtomicInt(&capture_records_dropped, 1);
+			return;
+		}
+		Wakeup_Signal(&capture_wakeup);
+		SDL_DelayNS(SDL_US_TO_NS(100));
+		tail = SDL_GetAtomicU32(&ring->tail);
+	}
+	ring->records[head & (CAPTURE_RING_CAPACITY - 1)] = *record;
+	SDL_SetAtomicU32(&ring->head, head + 1); // The writer thread picks it up on its next flush interval
+}
+
+bool Capture_IsActive(void)
+{
+	return capture_rings[CAPTURE_PRODUCER_INPUT] != NULL;
+}
+
+void Capture_Sensor(Uint64 timestamp_ns, Uint64 sensor_timestamp_ns, const float data[3])
+{
+	if (!Capture_IsActive()) return;
+	CaptureRecord record = { CAPTURE_SENSOR, timestamp_ns };
+	record.sensor.sensor_timestamp_ns = sensor_timestamp_ns;
+	SDL_memcpy(record.sensor.data, data, sizeof(record.sensor.data));
+	PushRecord(CAPTURE_PRODUCER_INPUT, &record);
+}
+
+void Capture_Button(Uint64 timestamp_ns, Uint8 button, bool down)
+{
+	if (!Capture_IsActive()) return;
+	CaptureRecord record = { CAPTURE_BUTTON, timestamp_ns };
+	record.button.button = button;
+	record.button.down = down;
+	PushRecord(CAPTURE_PRODUCER_INPUT, &record);
+}
+
+void Capture_Axis(Uint64 timestamp_ns, Uint8 axis, Sint16 value)
+{
+	if (!Capture_IsActive()) return;
+	CaptureRecord record = { CAPTURE_AXIS, timestamp_ns };
+	record.axis.axis = axis;
+	record.axis.value = value;
+	PushRecord(CAPTURE_PRODUCER_INPUT, &record);
+}
+
+void Capture_Packet(Uint64 timestamp_ns)
+{
+	if (!Capture_IsActive()) return;
+	CaptureRecord record = { CAPTURE_PACKET, timestamp_ns };
+	PushRecord(CAPTURE_PRODUCER_INPUT, &record);
+}
+
+void Capture_Aim(Uint64 timestamp_ns, bool aiming)
+{
+	if (!Capture_IsActive()) return;
+	CaptureRecord record = { CAPTURE_AIM, timestamp_ns };
+	record.aiming = aiming;
+	PushRecord(CAPTURE_PRODUCER_INPUT, &record);
+}
+
+void Capture_MouseMoves(const MouseMove* moves, int count)
+{
+	if (!Capture_IsActive()) return;
+	CaptureRecord record = { CAPTURE_MOUSE, Clock_GetTicksNS() };
+	for (int i = 0; i < count; ++i) {
+		record.mouse = moves[i];
+		PushRecord(CAPTURE_PRODUCER_MOUSE, &record);
+	}
+}
+
+void Capture_PadReport(const XUSB_REPORT* report)
+{
+	if (!Capture_IsActive()) return;
+	CaptureRecord record = { CAPTURE_PAD, Clock_GetTicksNS() };
+	record.pad = *report;
+	PushRecord(CAPTURE_PRODUCER_INPUT, &record);
+}
+
+// --- Writer ---
+static void WriteBytes(const void* data, size_t size)
+{
+	if (capture_write_failed) return;
+	if (fwrite(data, 1, size, capture_file) != size) {
+		SDL_Log("Capture: write failed, the rest of the session is not recorded.");
+		capture_write_failed = true;
+		return;
+	}
+	capture_file_offset += size;
+}
+
+static void FlushChunk(void)
+{
+	if (chunk_payload_bytes == 0) return;
+
+	if (chunk_count == chunk_index_capacity && chunk_count < CAPTURE_MAX_CHUNKS) {
+		int new_capacity = chunk_index_capacity ? chunk_index_capacity * 2 : 64;
+		CaptureChunkInfo* new_index = (CaptureChunkInfo*)SDL_realloc(chunk_index, new_capacity * sizeof(CaptureChunkInfo));
+		if (new_index) {
+			chunk_index = new_index;
+			chunk_index_capacity = new_capacity;
+		}
+	}
+
+	Uint8 header[CAPTURE_CHUNK_HEADER_BYTES] = { 0 };
+	PutU32(header, CAPTURE_CHUNK_MAGIC);
+	PutU32(header + 4, chunk_payload_bytes);
+	PutU32(header + 8, chunk_info.record_count);
+	PutU64(header + 16, chunk_info.first_timestamp_ns);
+	PutU64(header + 24, chunk_info.last_timestamp_ns);
+
+	chunk_info.file_offset = capture_file_offset;
+	WriteBytes(header, sizeof(header));
+	WriteBytes(chunk_payload, chunk_payload_bytes);
+	if (!capture_write_failed) fflush(capture_file); // Whole chunks survive a crash; the reader scans when the index is missing
+	if (chunk_count < chunk_index_capacity) chunk_index[chunk_count++] = chunk_info;
+	else chunk_index_incomplete = true;
+
+	chunk_payload_bytes = 0;
+	SDL_zero(chunk_info);
+	SDL_zero(writer_codec);
+}
+
+static void EncodeRecord(const CaptureRecord* record)
+{
+	if (chunk_payload_bytes + CAPTURE_MAX_RECORD_BYTES > CAPTURE_CHUNK_BYTES) FlushChunk();
+
+	Uint8* out = chunk_payload + chunk_payload_bytes;
+	Uint8* start = out;
+	Uint64 timestamp_us = record->timestamp_ns / SDL_NS_PER_US;
+
+	*out++ = (Uint8)record->type;
+	out += PutSignedVarint(out, (Sint64)(timestamp_us - writer_codec.timestamp_us));
+	writer_codec.timestamp_us = timestamp_us;
+
+	switch (record->type) {
+	case CAPTURE_SENSOR: {
+		Sint64 sensor_lag_us = (Sint64)(timestamp_us - record->sensor.sensor_timestamp_ns / SDL_NS_PER_US);
+		out += PutSignedVarint(out, sensor_lag_us - writer_codec.sensor_lag_us);
+		writer_codec.sensor_lag_us = sensor_lag_us;
+		for (int i = 0; i < 3; ++i) {
+			Sint32 value = QuantizeGyro(record->sensor.data[i]);
+			out += PutSignedVarint(out, (Sint64)value - writer_codec.gyro[i]);
+			writer_codec.gyro[i] = value;
+		}
+		break;
+	}
+	case CAPTURE_BUTTON:
+		*out++ = (Uint8)((record->button.button & 0x7F) | (record->button.down ? 0x80 : 0));
+		break;
+	case CAPTURE_AXIS:
+		*out++ = record->axis.axis;
+		out += PutSignedVarint(out, record->axis.value);
+		break;
+	case CAPTURE_AIM:
+		*out++ = record->aiming ? 1 : 0;
+		break;
+	case CAPTURE_MOUSE:
+		out += PutSignedVarint(out, record->mouse.dx);
+		out += PutSignedVarint(out, record->mouse.dy);
+		break;
+	case CAPTURE_PAD: {
+		// Mostly only the right stick moves between reports, so only changed fields are written, sticks as deltas.
+		const XUSB_REPORT* pad = &record->pad;
+		XUSB_REPORT* last = &writer_codec.pad;
+		Uint8* fields = out++;
+		*fields = 0;
+		if (pad->wButtons != last->wButtons) { *fields |= CAPTURE_PAD_BUTTONS; out += PutVarint(out, pad->wButtons); }
+		if (pad->bLeftTrigger != last->bLeftTrigger) { *fields |= CAPTURE_PAD_LEFT_TRIGGER; *out++ = pad->bLeftTrigger; }
+		if (pad->bRightTrigger != last->bRightTrigger) { *fields |= CAPTURE_PAD_RIGHT_TRIGGER; *out++ = pad->bRightTrigger; }
+		if (pad->sThumbLX != last->sThumbLX) { *fields |= CAPTURE_PAD_THUMB_LX; out += PutSignedVarint(out, pad->sThumbLX - last->sThumbLX); }
+		if (pad->sThumbLY != last->sThumbLY) { *fields |= CAPTURE_PAD_THUMB_LY; out += PutSignedVarint(out, pad->sThumbLY - last->sThumbLY); }
+		if (pad->sThumbRX != last->sThumbRX) { *fields |= CAPTURE_PAD_THUMB_RX; out += PutSignedVarint(out, pad->sThumbRX - last->sThumbRX); }
+		if (pad->sThumbRY != last->sThumbRY) { *fields |= CAPTURE_PAD_THUMB_RY; out += PutSignedVarint(out, pad->sThumbRY - last->sThumbRY); }
+		*last = *pad;
+		break;
+	}
+	default:
+		break;
+	}
+
+	if (chunk_info.record_count == 0) chunk_info.first_timestamp_ns = timestamp_us * SDL_NS_PER_US;
+	chunk_info.last_timestamp_ns = timestamp_us * SDL_NS_PER_US;
+	chunk_info.record_count++;
+	chunk_payload_bytes += (Uint32)(out - start);
+	records_written++;
+}
+
+// Merges both rings by timestamp so consecutive records stay close and their deltas small.
+static void DrainRings(void)
+{
+	Uint32 tails[CAPTURE_PRODUCER_COUNT], heads[CAPTURE_PRODUCER_COUNT];
+	for (int i = 0; i < CAPTURE_PRODUCER_COUNT; ++i) {
+		tails[i] = SDL_GetAtomicU32(&capture_rings[i]->tail);
+		heads[i] = SDL_GetAtomicU32(&capture_rings[i]->head);
+	}
+
+	for (;;) {
+		int next = -1;
+		Uint64 next_timestamp = 0;
+		for (int i = 0; i < CAPTURE_PRODUCER_COUNT; ++i) {
+			if (tails[i] == heads[i]) continue;
+			Uint64 timestamp = capture_rings[i]->records[tails[i] & (CAPTURE_RING_CAPACITY - 1)].timestamp_ns;
+			if (next < 0 || timestamp < next_timestamp) {
+				next = i;
+				next_timestamp = timestamp;
+			}
+		}
+		if (next < 0) break;
+
+		EncodeRecord(&capture_rings[next]->records[tails[next] & (CAPTURE_RING_CAPACITY - 1)]);
+		tails[next]++;
+		SDL_SetAtomicU32(&capture_rings[next]->tail, tails[next]); // Hands the slot back to the producer
+	}
+}
+
+static int SDLCALL CaptureThread(void* data)
+{
+	while (run_capture_thread) {
+		Wakeup_Wait(&capture_wakeup, CAPTURE_FLUSH_INTERVAL_MS);
+		DrainRings();
+	}
+	DrainRings();
+	return 0;
+}
+
+static void WriteFileHeader(void)
+{
+	// The settings are stored as profile text, so a capture outlives changes to the AppSettings layout.
+	char settings_text[SETTINGS_TEXT_MAX];
+	size_t settings_length = SDL_min(FormatSettings(&settings, true, settings_text, sizeof(settings_text)), sizeof(settings_text) - 1);
+
+	Uint8 header[CAPTURE_HEADER_BYTES] = { 0 };
+	SDL_memcpy(header, CAPTURE_FILE_MAGIC, sizeof(CAPTURE_FILE_MAGIC));
+	PutU32(header + 8, CAPTURE_FILE_VERSION);
+	PutU32(header + 12, (Uint32)settings_length);
+	PutU64(header + 16, capture_start_ns);
+	SDL_strlcpy((char*)header + 24, current_profile_name, 64);
+	WriteBytes(header, sizeof(header));
+	WriteBytes(settings_text, settings_length);
+}
+
+static void WriteIndexAndFooter(void)
+{
+	Uint64 index_offset = capture_file_offset;
+	Uint8 bytes[CAPTURE_INDEX_ENTRY_BYTES];
+
+	PutU32(bytes, CAPTURE_INDEX_MAGIC);
+	PutU32(bytes + 4, (Uint32)chunk_count);
+	WriteBytes(bytes, 8);
+	for (int i = 0; i < chunk_count; ++i) {
+		SDL_zero(bytes);
+		PutU64(bytes, chunk_index[i].file_offset);
+		PutU64(bytes + 8, chunk_index[i].first_timestamp_ns);
+		PutU64(bytes + 16, chunk_index[i].last_timestamp_ns);
+		PutU32(bytes + 24, chunk_index[i].record_count);
+		WriteBytes(bytes, CAPTURE_INDEX_ENTRY_BYTES);
+	}
+
+	PutU64(bytes, index_offset);
+	PutU32(bytes + 8, (Uint32)chunk_count);
+	PutU32(bytes + 12, CAPTURE_FOOTER_MAGIC);
+	WriteBytes(bytes, CAPTURE_FOOTER_BYTES);
+}
+
+bool Capture_Start(const char* path, bool block_when_full)
+{
+	if (fopen_s(&capture_file, path, "wb") != 0 || !capture_file) {
+		SDL_Log("Capture: could not open '%s' for writing.", path);
+		capture_file = NULL;
+		return false;
+	}
+	if (!Wakeup_Init(&capture_wakeup)) {
+		SDL_Log("Capture: could not create the writer thread wakeup event.");
+		fclose(capture_file);
+		capture_file = NULL;
+		return false;
+	}
+
+	capture_file_offset = 0;
+	chunk_payload_bytes = 0;
+	chunk_count = 0;
+	chunk_index_incomplete = false;
+	records_written = 0;
+	capture_write_failed = false;
+	capture_blocks_when_full = block_when_full;
+	SDL_zero(chunk_info);
+	SDL_zero(writer_codec);
+	SDL_SetAtomicInt(&capture_records_dropped, 0);
+	capture_start_ns = SDL_GetTicksNS();
+	WriteFileHeader();
+
+	run_capture_thread = true;
+	for (int i = 0; i < CAPTURE_PRODUCER_COUNT; ++i) capture_rings[i] = (CaptureRing*)SDL_calloc(1, sizeof(CaptureRing));
+	capture_thread = (capture_rings[CAPTURE_PRODUCER_INPUT] && capture_rings[CAPTURE_PRODUCER_MOUSE])
+		? SDL_CreateThread(CaptureThread, "CaptureThread", NULL) : NULL;
+	if (!capture_thread) {
+		SDL_Log("Capture: could not start the writer thread.");
+		run_capture_thread = false;
+		Capture_Stop();
+		return false;
+	}
+	SDL_Log("Capturing session to '%s'.", path);
+	return true;
+}
+
+// Call once the producing threads have stopped.
+void Capture_Stop(void)
+{
+	if (!capture_file) return;
+
+	if (capture_thread) {
+		run_capture_thread = false;
+		Wakeup_Signal(&capture_wakeup);
+		SDL_WaitThread(capture_thread, NULL);
+		capture_thread = NULL;
+
+		FlushChunk();
+		if (!chunk_index_incomplete) WriteIndexAndFooter(); // Without one, readers rebuild it by scanning
+		double seconds = (double)(SDL_GetTicksNS() - capture_start_ns) / 1e9;
+		SDL_Log("Capture stopped. %llu records in %d chunks, %llu bytes (%.0f bytes/s), %d records dropped on queue overflow.",
+			(unsigned long long)records_written, chunk_count, (unsigned long long)capture_file_offset,
+			seconds > 0.0 ? capture_file_offset / seconds : 0.0, SDL_GetAtomicInt(&capture_records_dropped));
+	}
+
+	for (int i = 0; i < CAPTURE_PRODUCER_COUNT; ++i) {
+		SDL_free(capture_rings[i]);
+		capture_rings[i] = NULL;
+	}
+	fclose(capture_file);
+	capture_file = NULL;
+	SDL_free(chunk_index);
+	chunk_index = NULL;
+	chunk_index_capacity = 0;
+	Wakeup_Destroy(&capture_wakeup);
+}
+
+// --- Reader ---
+static bool LoadIndexFromFooter(Uint64 header_end)
+{
+	if (reader_size < header_end + 8 + CAPTURE_FOOTER_BYTES) return false;
+	const Uint8* footer = reader_data + reader_size - CAPTURE_FOOTER_BYTES;
+	if (GetU32(footer + 12) != CAPTURE_FOOTER_MAGIC) return false;
+
+	Uint64 index_offset = GetU64(footer);
+	Uint32 count = GetU32(footer + 8);
+	if (index_offset < header_end || count > CAPTURE_MAX_CHUNKS) return false;
+	if (index_offset + 8 + (Uint64)count * CAPTURE_INDEX_ENTRY_BYTES + CAPTURE_FOOTER_BYTES != reader_size) return false;
+	if (GetU32(reader_data + index_offset) != CAPTURE_INDEX_MAGIC || GetU32(reader_data + index_offset + 4) != count) return false;
+
+	reader_chunks = (CaptureChunkInfo*)SDL_calloc(count ? count : 1, sizeof(CaptureChunkInfo));
+	if (!reader_chunks) return false;
+	const Uint8* entry = reader_data + index_offset + 8;
+	for (Uint32 i = 0; i < count; ++i, entry += CAPTURE_INDEX_ENTRY_BYTES) {
+		CaptureChunkInfo* info = &reader_chunks[i];
+		info->file_offset = GetU64(entry);
+		info->first_timestamp_ns = GetU64(entry + 8);
+		info->last_timestamp_ns = GetU64(entry + 16);
+		info->record_count = GetU32(entry + 24);
+		if (info->file_offset < header_end || info->file_offset + CAPTURE_CHUNK_HEADER_BYTES > index_offset ||
+			info->file_offset + CAPTURE_CHUNK_HEADER_BYTES + GetU32(reader_data + info->file_offset + 4) > index_offset) {
+			SDL_free(reader_chunks);
+			reader_chunks = NULL;
+			return false;
+		}
+	}
+	reader_chunk_count = (int)count;
+	return true;
+}
+
+// Rebuilds the index by walking the chunk headers, for files whose writer never got to close them.
+static bool ScanChunks(Uint64 header_end)
+{
+	int capacity = 0;
+	Uint64 offset = header_end;
+	reader_chunk_count = 0;
+	while (offset + CAPTURE_CHUNK_HEADER_BYTES <= reader_size && GetU32(reader_data + offset) == CAPTURE_CHUNK_MAGIC) {
+		Uint32 payload_bytes = GetU32(reader_data + offset + 4);
+		if (offset + CAPTURE_CHUNK_HEADER_BYTES + payload_bytes > reader_size) break; // Truncated last chunk
+
+		if (reader_chunk_count == capacity) {
+			int new_capacity = capacity ? capacity * 2 : 64;
+			CaptureChunkInfo* new_chunks = (CaptureChunkInfo*)SDL_realloc(reader_chunks, new_capacity * sizeof(CaptureChunkInfo));
+			if (!new_chunks) return false;
+			reader_chunks = new_chunks;
+			capacity = new_capacity;
+		}
+		CaptureChunkInfo* info = &reader_chunks[reader_chunk_count++];
+		info->file_offset = offset;
+		info->record_count = GetU32(reader_data + offset + 8);
+		info->first_timestamp_ns = GetU64(reader_data + offset + 16);
+		info->last_timestamp_ns = GetU64(reader_data + offset + 24);
+		offset += CAPTURE_CHUNK_HEADER_BYTES + payload_bytes;
+	}
+	SDL_Log("Capture: no valid index, recovered %d chunks by scanning.", reader_chunk_count);
+	return true;
+}
+
+static bool EnterChunk(int chunk)
+{
+	reader_chunk = chunk;
+	if (chunk >= reader_chunk_count) return false;
+
+	const Uint8* header = reader_data + reader_chunks[chunk].file_offset;
+	reader_pos = (size_t)reader_chunks[chunk].file_offset + CAPTURE_CHUNK_HEADER_BYTES;
+	reader_chunk_end = reader_pos + GetU32(header + 4);
+	reader_records_left = GetU32(header + 8);
+	SDL_zero(reader_codec);
+	return true;
+}
+
+static bool DecodeRecord(CaptureRecord* record)
+{
+	Uint8 type;
+	Sint64 delta;
+	if (!GetByte(&type) || type >= CAPTURE_RECORD_TYPE_COUNT || !GetSignedVarint(&delta)) return false;
+
+	SDL_zerop(record);
+	record->type = (CaptureRecordType)type;
+	reader_codec.timestamp_us += (Uint64)delta;
+	record->timestamp_ns = reader_codec.timestamp_us * SDL_NS_PER_US;
+
+	Uint8 byte;
+	Uint64 raw;
+	Sint64 values[4];
+	switch (record->type) {
+	case CAPTURE_SENSOR:
+		if (!GetSignedVarint(&delta)) return false;
+		reader_codec.sensor_lag_us += delta;
+		record->sensor.sensor_timestamp_ns = (reader_codec.timestamp_us - (Uint64)reader_codec.sensor_lag_us) * SDL_NS_PER_US;
+		for (int i = 0; i < 3; ++i) {
+			if (!GetSignedVarint(&delta)) return false;
+			reader_codec.gyro[i] += (Sint32)delta;
+			record->sensor.data[i] = reader_codec.gyro[i] / CAPTURE_GYRO_SCALE;
+		}
+		break;
+	case CAPTURE_BUTTON:
+		if (!GetByte(&byte)) return false;
+		record->button.button = byte & 0x7F;
+		record->button.down = (byte & 0x80) != 0;
+		break;
+	case CAPTURE_AXIS:
+		if (!GetByte(&record->axis.axis) || !GetSignedVarint(&values[0])) return false;
+		record->axis.value = (Sint16)values[0];
+		break;
+	case CAPTURE_AIM:
+		if (!GetByte(&byte)) return false;
+		record->aiming = byte != 0;
+		break;
+	case CAPTURE_MOUSE:
+		if (!GetSignedVarint(&values[0]) || !GetSignedVarint(&values[1])) return false;
+		record->mouse.dx = (Sint32)values[0];
+		record->mouse.dy = (Sint32)values[1];
+		break;
+	case CAPTURE_PAD: {
+		XUSB_REPORT* pad = &reader_codec.pad;
+		Sint16* thumbs[4] = { &pad->sThumbLX, &pad->sThumbLY, &pad->sThumbRX, &pad->sThumbRY };
+		if (!GetByte(&byte)) return false;
+		if (byte & CAPTURE_PAD_BUTTONS) {
+			if (!GetVarint(&raw)) return false;
+			pad->wButtons = (Uint16)raw;
+		}
+		if ((byte & CAPTURE_PAD_LEFT_TRIGGER) && !GetByte(&pad->bLeftTrigger)) return false;
+		if ((byte & CAPTURE_PAD_RIGHT_TRIGGER) && !GetByte(&pad->bRightTrigger)) return false;
+		for (int i = 0; i < 4; ++i) {
+			if (!(byte & (CAPTURE_PAD_THUMB_LX << i))) continue;
+			if (!GetSignedVarint(&values[i])) return false;
+			*thumbs[i] = (Sint16)(*thumbs[i] + values[i]);
+		}
+		record->pad = *pad;
+		break;
+	}
+	default:
+		break;
+	}
+	return true;
+}
+
+// Maps the file instead of reading it in, so an hours-long capture costs address space rather than a copy in memory,
+// and the pages the reader has passed can be dropped again. The size is 64-bit throughout.
+static bool MapCaptureFile(const char* path)
+{
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file == INVALID_HANDLE_VALUE) return false;
+	LARGE_INTEGER size;
+	HANDLE mapping = NULL;
+	if (GetFileSizeEx(file, &size) && size.QuadPart > 0 && (Uint64)size.QuadPart <= SIZE_MAX) {
+		mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	}
+	CloseHandle(file); // The mapping keeps the file open
+	if (!mapping) return false;
+	const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping); // The view keeps the mapping alive
+	if (!view) return false;
+	reader_size = (size_t)size.QuadPart;
+#else
+	int fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0) return false;
+	struct stat info;
+	void* view = MAP_FAILED;
+	if (fstat(fd, &info) == 0 && info.st_size > 0 && (Uint64)info.st_size <= SIZE_MAX) {
+		view = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	}
+	close(fd); // The mapping keeps the file open
+	if (view == MAP_FAILED) return false;
+	madvise(view, (size_t)info.st_size, MADV_SEQUENTIAL);
+	reader_size = (size_t)info.st_size;
+#endif
+	reader_data = (const Uint8*)view;
+	return true;
+}
+
+static void UnmapCaptureFile(void)
+{
+	if (!reader_data) return;
+#ifdef _WIN32
+	UnmapViewOfFile(reader_data);
+#else
+	munmap((void*)reader_data, reader_size);
+#endif
+	reader_data = NULL;
+	reader_size = 0;
+}
+
+bool Capture_OpenReader(const char* path, AppSettings* loaded_settings, char* profile_name, size_t profile_name_size)
+{
+	Capture_CloseReader();
+
+	if (!MapCaptureFile(path)) {
+		SDL_Log("Capture: could not open '%s'.", path);
+		return false;
+	}
+	if (reader_size < CAPTURE_HEADER_BYTES || SDL_memcmp(reader_data, CAPTURE_FILE_MAGIC, sizeof(CAPTURE_FILE_MAGIC)) != 0) {
+		SDL_Log("Capture: '%s' is not a capture file.", path);
+		Capture_CloseReader();
+		return false;
+	}
+	Uint32 version = GetU32(reader_data + 8);
+	Uint32 settings_size = GetU32(reader_data + 12);
+	if (version != CAPTURE_FILE_VERSION || reader_size < CAPTURE_HEADER_BYTES + (Uint64)settings_size) {
+		SDL_Log("Capture: '%s' has version %u with %u settings bytes; this build reads version %d.",
+			path, version, settings_size, CAPTURE_FILE_VERSION);
+		Capture_CloseReader();
+		return false;
+	}
+
+	reader_start_ns = GetU64(reader_data + 16);
+	if (profile_name) SDL_strlcpy(profile_name, (const char*)reader_data + 24, SDL_min(profile_name_size, 64));
+	if (loaded_settings) ParseSettings(loaded_settings, (const char*)reader_data + CAPTURE_HEADER_BYTES, settings_size);
+
+	Uint64 header_end = CAPTURE_HEADER_BYTES + settings_size;
+	if (!LoadIndexFromFooter(header_end) && !ScanChunks(header_end)) {
+		Capture_CloseReader();
+		return false;
+	}
+	EnterChunk(0);
+	return true;
+}
+
+bool Capture_ReadNext(CaptureRecord* record)
+{
+	while (reader_chunk < reader_chunk_count) {
+		if (reader_records_left > 0) {
+			if (DecodeRecord(record)) {
+				reader_records_left--;
+				return true;
+			}
+			SDL_Log("Capture: chunk %d is corrupt, skipping the rest of it.", reader_chunk);
+		}
+		EnterChunk(reader_chunk + 1);
+	}
+	return false;
+}
+
+bool Capture_SeekReader(Uint64 timestamp_ns)
+{
+	int chunk = 0;
+	while (chunk + 1 < reader_chunk_count && reader_chunks[chunk + 1].first_timestamp_ns <= timestamp_ns) chunk++;
+	if (!EnterChunk(chunk)) return false;
+
+	// Decode up to the target inside the chunk, then rewind to the first record at or after it.
+	for (;;) {
+		size_t pos = reader_pos;
+		Uint32 records_left = reader_records_left;
+		CaptureCodecState codec = reader_codec;
+		int current_chunk = reader_chunk;
+		CaptureRecord record;
+		if (!Capture_ReadNext(&record)) return false;
+		if (record.timestamp_ns >= timestamp_ns) {
+			if (reader_chunk == current_chunk) {
+				reader_pos = pos;
+				reader_records_left = records_left;
+				reader_codec = codec;
+			}
+			else {
+				EnterChunk(reader_chunk); // The record opened a new chunk; start that chunk over
+			}
+			return true;
+		}
+	}
+}
+
+Uint64 Capture_GetReaderStartTime(void)
+{
+	return reader_start_ns;
+}
+
+void Capture_CloseReader(void)
+{
+	UnmapCaptureFile();
+	SDL_free(reader_chunks);
+	reader_chunks = NULL;
+	reader_chunk_count = 0;
+	reader_chunk = 0;
+	reader_records_left = 0;
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include "state.h"
+
+// Session capture: producers queue records into per-thread rings and a writer thread encodes them into a
+// chunked file. A full ring drops records rather than stalling the producer.
+//
+// File layout (little-endian):
+//   header   "UGACAPT\0", u32 version, u32 settings size, u64 start ns, char profile[64], settings text
+//   chunks   u32 'UGCK', u32 payload bytes, u32 records, u32 reserved, u64 first ns, u64 last ns, payload
+//   index    u32 'UGIX', u32 chunk count, per chunk: u64 offset, u64 first ns, u64 last ns, u32 records, u32 reserved
+//   footer   u64 index offset, u32 chunk count, u32 'UGFT'
+// Records are a type byte and a zigzag varint timestamp delta in microseconds, followed by the type's fields.
+// Timestamps, gyro values and the sensor timestamp's lag behind the event timestamp are delta-encoded against
+// the previous record of the same chunk, so every chunk decodes on its own. Pad records start with a byte of
+// CAPTURE_PAD_* flags and carry only the fields that changed since the previous pad record, sticks as deltas.
+// A file without an index (e.g. after a crash) is read by scanning. The settings text is the key = value lines of
+// a profile with exact floats; keys a build does not know are ignored and missing ones keep their defaults.
+bool Capture_Start(const char* path, bool block_when_full); // Blocking suits producers that are not real-time (replay)
+void Capture_Stop(void);
+bool Capture_IsActive(void);
+
+// Producers. Input thread: everything but mouse moves. Mouse thread: mouse moves.
+void Capture_Sensor(Uint64 timestamp_ns, Uint64 sensor_timestamp_ns, const float data[3]);
+void Capture_Button(Uint64 timestamp_ns, Uint8 button, bool down);
+void Capture_Axis(Uint64 timestamp_ns, Uint8 axis, Sint16 value);
+void Capture_Packet(Uint64 timestamp_ns);
+void Capture_Aim(Uint64 timestamp_ns, bool aiming);
+void Capture_MouseMoves(const MouseMove* moves, int count);
+void Capture_PadReport(const XUSB_REPORT* report);
+
+// Reader for a finished or interrupted capture file. Records come back in file order.
+bool Capture_OpenReader(const char* path, AppSettings* settings, char* profile_name, size_t profile_name_size);
+bool Capture_ReadNext(CaptureRecord* record);
+bool Capture_SeekReader(Uint64 timestamp_ns); // Next record read is the first at or after timestamp_ns
+Uint64 Capture_GetReaderStartTime(void);
+void Capture_CloseReader(void);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,21 @@
+#include "clock.h"
+
+// Only replay sets these, and it drives the pipeline from a single thread.
+static bool use_virtual_time = false;
+static Uint64 virtual_now_ns = 0;
+
+Uint64 Clock_GetTicksNS(void)
+{
+	return use_virtual_time ? virtual_now_ns : SDL_GetTicksNS();
+}
+
+void Clock_SetVirtualTime(Uint64 now_ns)
+{
+	virtual_now_ns = now_ns;
+	use_virtual_time = true;
+}
+
+void Clock_UseRealTime(void)
+{
+	use_virtual_time = false;
+}
\ No newline at end of file
@@ -0,0 +1,12 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include "state.h"
+
+// Time source for everything the pipeline decides on. Live it is SDL's monotonic clock; replay substitutes
+// the recorded timestamps so a session runs identically at any speed.
+Uint64 Clock_GetTicksNS(void);
+void Clock_SetVirtualTime(Uint64 now_ns); // Until Clock_UseRealTime, Clock_GetTicksNS returns now_ns
+void Clock_UseRealTime(void);
+
+#endif
\ No newline at end of file
@@ -1,48 +1,78 @@
 #include "config.h"
-#include <shlwapi.h>
-#pragma comment(lib, "shlwapi.lib")
-#include <ShlObj.h>
-#include <direct.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <stdarg.h>
 
-static bool GetProfilesDir(char* path_buffer, size_t buffer_size)
+bool GetProfilesDir(char* path_buffer, size_t buffer_size)
 {
-	if (GetModuleFileNameA(NULL, path_buffer, (DWORD)buffer_size) == 0) {
+	const char* base_path = SDL_GetBasePath(); // Includes the trailing separator
+	if (!base_path) {
 		return false;
 	}
-	PathRemoveFileSpecA(path_buffer);
-
-	if (PathAppendA(path_buffer, PROFILES_DIRECTORY) == FALSE) {
+	if (SDL_snprintf(path_buffer, buffer_size, "%s%s", base_path, PROFILES_DIRECTORY) >= (int)buffer_size) {
 		return false;
 	}
-	_mkdir(path_buffer);
+	SDL_CreateDirectory(path_buffer);
 
 	return true;
 }
 
+static bool HasIniExtension(const char* filename)
+{
+	const char* extension = strrchr(filename, '.');
+	return extension && _stricmp(extension, ".ini") == 0;
+}
+
+static bool GetProfilePath(const char* profile_name, char* path_buffer, size_t buffer_size)
+{
+	char dir_path[MAX_PATH];
+	if (!GetProfilesDir(dir_path, MAX_PATH)) {
+		return false;
+	}
+	int length = SDL_snprintf(path_buffer, buffer_size, "%s/%s%s", dir_path, profile_name, HasIniExtension(profile_name) ? "" : ".ini");
+	return length < (int)buffer_size;
+}
+
+static char* TrimWhitespace(char* str)
+{
+	while (isspace((unsigned char)*str)) str++;
+	char* end = str + strlen(str);
+	while (end > str && isspace((unsigned char)*(end - 1))) end--;
+	*end = 0;
+	return str;
+}
+
+static void ResetSettings(AppSettings* target) {
+	target->selected_button = -1;
+	target->selected_axis = -1;
+	target->sensitivity = 5.0f;
+	target->invert_gyro_x = false;
+	target->invert_gyro_y = false;
+	target->anti_deathzone = 0.0f;
+	target->always_on_gyro = false;
+	target->mouse_mode = false;
+	target->mouse_sensitivity = 5000.0f;
+	target->config_version = CURRENT_CONFIG_VERSION;
+	target->led_r = 48;
+	target->led_g = 48;
+	target->led_b = 48;
+	target->gyro_calibration_offset[0] = 0.0f;
+	target->gyro_calibration_offset[1] = 0.0f;
+	target->gyro_calibration_offset[2] = 0.0f;
+	target->flick_stick_enabled = false;
+	target->flick_stick_calibrated = false;
+	target->flick_stick_calibration_value = 12000.0f;
+	target->mouse_poll_rate = 0;
+	target->mouse_max_step = 0;
+	target->pad_keepalive_ms = 1000;
+	target->headless = false;
+}
+
 void SetDefaultSettings(void) {
 	SDL_Log("Loading default settings.");
-	settings.selected_button = -1;
-	settings.selected_axis = -1;
-	settings.sensitivity = 5.0f;
-	settings.invert_gyro_x = false;
-	settings.invert_gyro_y = false;
-	settings.anti_deathzone = 0.0f;
-	settings.always_on_gyro = false;
-	settings.mouse_mode = false;
-	settings.mouse_sensitivity = 5000.0f;
-	settings.config_version = CURRENT_CONFIG_VERSION;
-	settings.led_r = 48;
-	settings.led_g = 48;
-	settings.led_b = 48;
-	settings.gyro_calibration_offset[0] = 0.0f;
-	settings.gyro_calibration_offset[1] = 0.0f;
-	settings.gyro_calibration_offset[2] = 0.0f;
-	settings.flick_stick_enabled = false;
-	settings.flick_stick_calibrated = false;
-	settings.flick_stick_calibration_value = 12000.0f;
+	ResetSettings(&settings);
 }
 
 static SDL_GamepadButton GamepadButtonFromString(const char* str) {
@@ -83,17 +113,164 @@ static bool ParseHexColor(const char* hex_string, unsigned char* r, unsigned cha
 	return (result == 3);
 }
 
+static void AppendSetting(char* buffer, size_t buffer_size, size_t* length, const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	int written = (*length < buffer_size) ? SDL_vsnprintf(buffer + *length, buffer_size - *length, format, args) : 0;
+	va_end(args);
+	if (written > 0) *length += written;
+}
+
+size_t FormatSettings(const AppSettings* source, bool exact, char* buffer, size_t buffer_size)
+{
+	// %.9g gives back the same float when parsed; %f keeps profiles readable.
+	const char* float_format = exact ? "%s = %.9g\n" : "%s = %f\n";
+	size_t length = 0;
+	if (buffer_size) buffer[0] = 0;
+	AppendSetting(buffer, buffer_size, &length, "mouse_mode = %s\n", source->mouse_mode ? "true" : "false");
+	AppendSetting(buffer, buffer_size, &length, float_format, "sensitivity", source->sensitivity);
+	AppendSetting(buffer, buffer_size, &length, float_format, "mouse_sensitivity", source->mouse_sensitivity);
+	AppendSetting(buffer, buffer_size, &length, "always_on_gyro = %s\n", source->always_on_gyro ? "true" : "false");
+	AppendSetting(buffer, buffer_size, &length, "invert_gyro_x = %s\n", source->invert_gyro_x ? "true" : "false");
+	AppendSetting(buffer, buffer_size, &length, "invert_gyro_y = %s\n", source->invert_gyro_y ? "true" : "false");
+	AppendSetting(buffer, buffer_size, &length, float_format, "anti_deadzone", source->anti_deathzone);
+	if (source->selected_button != -1) {
+		AppendSetting(buffer, buffer_size, &length, "aim_input_type = button\n");
+		AppendSetting(buffer, buffer_size, &length, "aim_input_value = %s\n", SDL_GetGamepadStringForButton(source->selected_button));
+	}
+	else if (source->selected_axis != -1) {
+		AppendSetting(buffer, buffer_size, &length, "aim_input_type = axis\n");
+		AppendSetting(buffer, buffer_size, &length, "aim_input_value = %s\n", SDL_GetGamepadStringForAxis(source->selected_axis));
+	}
+	else {
+		AppendSetting(buffer, buffer_size, &length, "aim_input_type = none\n");
+	}
+	AppendSetting(buffer, buffer_size, &length, "led_color = #%02X%02X%02X\n", source->led_r, source->led_g, source->led_b);
+	AppendSetting(buffer, buffer_size, &length, float_format, "gyro_offset_pitch", source->gyro_calibration_offset[0]);
+	AppendSetting(buffer, buffer_size, &length, float_format, "gyro_offset_yaw", source->gyro_calibration_offset[1]);
+	AppendSetting(buffer, buffer_size, &length, float_format, "gyro_offset_roll", source->gyro_calibration_offset[2]);
+	AppendSetting(buffer, buffer_size, &length, "flick_stick_enabled = %s\n", source->flick_stick_enabled ? "true" : "false");
+	AppendSetting(buffer, buffer_size, &length, "flick_stick_calibrated = %s\n", source->flick_stick_calibrated ? "true" : "false");
+	AppendSetting(buffer, buffer_size, &length, float_format, "flick_stick_value", source->flick_stick_calibration_value);
+	AppendSetting(buffer, buffer_size, &length, "mouse_poll_rate = %d\n", source->mouse_poll_rate);
+	AppendSetting(buffer, buffer_size, &length, "mouse_max_step = %d\n", source->mouse_max_step);
+	AppendSetting(buffer, buffer_size, &length, "pad_keepalive_ms = %d\n", source->pad_keepalive_ms);
+	AppendSetting(buffer, buffer_size, &length, "headless = %s\n", source->headless ? "true" : "false");
+	return length;
+}
+
+// Splits a "key = value" line in place; false for comments, section headers and lines without both parts.
+static bool SplitSettingLine(char* line, char** key, char** value)
+{
+	if (line[0] == '#' || line[0] == '\n' || line[0] == '\r' || line[0] == '[') return false;
+	char* separator = strchr(line, '=');
+	if (!separator) return false;
+	*separator = 0;
+	*key = TrimWhitespace(line);
+	*value = TrimWhitespace(separator + 1);
+	return (*key)[0] != 0 && (*value)[0] != 0;
+}
+
+// Unknown keys are ignored, so a file from an older or newer build still loads.
+static void ApplySetting(AppSettings* target, const char* key, const char* value, char* aim_type, size_t aim_type_size)
+{
+	if (_stricmp(key, "mouse_mode") == 0) {
+		target->mouse_mode = (_stricmp(value, "true") == 0);
+	}
+	else if (_stricmp(key, "sensitivity") == 0) {
+		target->sensitivity = (float)atof(value);
+	}
+	else if (_stricmp(key, "mouse_sensitivity") == 0) {
+		target->mouse_sensitivity = (float)atof(value);
+	}
+	else if (_stricmp(key, "always_on_gyro") == 0) {
+		target->always_on_gyro = (_stricmp(value, "true") == 0);
+	}
+	else if (_stricmp(key, "invert_gyro_x") == 0) {
+		target->invert_gyro_x = (_stricmp(value, "true") == 0);
+	}
+	else if (_stricmp(key, "invert_gyro_y") == 0) {
+		target->invert_gyro_y = (_stricmp(value, "true") == 0);
+	}
+	else if (_stricmp(key, "anti_deadzone") == 0) {
+		target->anti_deathzone = (float)atof(value);
+	}
+	else if (_stricmp(key, "aim_input_type") == 0) {
+		strcpy_s(aim_type, aim_type_size, value);
+	}
+	else if (_stricmp(key, "aim_input_value") == 0) {
+		if (_stricmp(aim_type, "button") == 0) {
+			target->selected_button = GamepadButtonFromString(value); target->selected_axis = -1;
+		}
+		else if (_stricmp(aim_type, "axis") == 0) {
+			target->selected_axis = GamepadAxisFromString(value); target->selected_button = -1;
+		}
+	}
+	else if (_stricmp(key, "led_color") == 0) {
+		ParseHexColor(value, &target->led_r, &target->led_g, &target->led_b);
+	}
+	else if (_stricmp(key, "gyro_offset_pitch") == 0) {
+		target->gyro_calibration_offset[0] = (float)atof(value);
+	}
+	else if (_stricmp(key, "gyro_offset_yaw") == 0) {
+		target->gyro_calibration_offset[1] = (float)atof(value);
+	}
+	else if (_stricmp(key, "gyro_offset_roll") == 0) {
+		target->gyro_calibration_offset[2] = (float)atof(value);
+	}
+	else if (_stricmp(key, "flick_stick_enabled") == 0) {
+		target->flick_stick_enabled = (_stricmp(value, "true") == 0);
+	}
+	else if (_stricmp(key, "flick_stick_calibrated") == 0) {
+		target->flick_stick_calibrated = (_stricmp(value, "true") == 0);
+	}
+	else if (_stricmp(key, "flick_stick_value") == 0) {
+		target->flick_stick_calibration_value = (float)atof(value);
+	}
+	else if (_stricmp(key, "mouse_poll_rate") == 0) {
+		target->mouse_poll_rate = CLAMP(atoi(value), 0, 8000);
+	}
+	else if (_stricmp(key, "mouse_max_step") == 0) {
+		target->mouse_max_step = CLAMP(atoi(value), 0, 1000);
+	}
+	else if (_stricmp(key, "pad_keepalive_ms") == 0) {
+		target->pad_keepalive_ms = CLAMP(atoi(value), 0, 60000);
+	}
+	else if (_stricmp(key, "headless") == 0) {
+		target->headless = (_stricmp(value, "true") == 0);
+	}
+}
+
+void ParseSettings(AppSettings* target, const char* text, size_t length)
+{
+	ResetSettings(target);
+	char line[256], aim_type[32] = "none";
+	const char* end = text + length;
+	while (text < end) {
+		const char* line_end = memchr(text, '\n', end - text);
+		size_t line_length = (line_end ? line_end : end) - text;
+		if (line_length < sizeof(line)) {
+			memcpy(line, text, line_length);
+			line[line_length] = 0;
+			char *key, *value;
+			if (SplitSettingLine(line, &key, &value)) ApplySetting(target, key, value, aim_type, sizeof(aim_type));
+		}
+		text += line_length + (line_end ? 1 : 0);
+	}
+}
+
 void SaveSettings(const char* profile_name) {
-	char dir_path[MAX_PATH];
-	if (!GetProfilesDir(dir_path, MAX_PATH)) {
+	char full_path[MAX_PATH];
+	if (!GetProfilePath(profile_name, full_path, MAX_PATH)) {
 		SDL_Log("Error: Could not determine profiles directory path.");
 		return;
 	}
 
-	char full_path[MAX_PATH];
-	PathCombineA(full_path, dir_path, profile_name);
-	if (!PathMatchSpecA(full_path, "*.ini")) {
-		strcat_s(full_path, MAX_PATH, ".ini");
+	char text[SETTINGS_TEXT_MAX];
+	if (FormatSettings(&settings, false, text, sizeof(text)) >= sizeof(text)) {
+		SDL_Log("Error: Settings do not fit in %d bytes.", SETTINGS_TEXT_MAX);
+		return;
 	}
 
 	FILE* file;
@@ -104,31 +281,7 @@ void SaveSettings(const char* profile_name) {
 
 	fprintf(file, "# Universal Gyro Aim Profile: %s\n", profile_name);
 	fprintf(file, "config_version = %d\n\n", CURRENT_CONFIG_VERSION);
-	fprintf(file, "mouse_mode = %s\n", settings.mouse_mode ? "true" : "false");
-	fprintf(file, "sensitivity = %f\n", settings.sensitivity);
-	fprintf(file, "mouse_sensitivity = %f\n", settings.mouse_sensitivity);
-	fprintf(file, "always_on_gyro = %s\n", settings.always_on_gyro ? "true" : "false");
-	fprintf(file, "invert_gyro_x = %s\n", settings.invert_gyro_x ? "true" : "false");
-	fprintf(file, "invert_gyro_y = %s\n", settings.invert_gyro_y ? "true" : "false");
-	fprintf(file, "anti_deadzone = %f\n", settings.anti_deathzone);
-	if (settings.selected_button != -1) {
-		fprintf(file, "aim_input_type = button\n");
-		fprintf(file, "aim_input_value = %s\n", SDL_GetGamepadStringForButton(settings.selected_button));
-	}
-	else if (settings.selected_axis != -1) {
-		fprintf(file, "aim_input_type = axis\n");
-		fprintf(file, "aim_input_value = %s\n", SDL_GetGamepadStringForAxis(settings.selected_axis));
-	}
-	else {
-		fprintf(file, "aim_input_type = none\n");
-	}
-	fprintf(file, "led_color = #%02X%02X%02X\n", settings.led_r, settings.led_g, settings.led_b);
-	fprintf(file, "gyro_offset_pitch = %f\n", settings.gyro_calibration_offset[0]);
-	fprintf(file, "gyro_offset_yaw = %f\n", settings.gyro_calibration_offset[1]);
-	fprintf(file, "gyro_offset_roll = %f\n", settings.gyro_calibration_offset[2]);
-	fprintf(file, "flick_stick_enabled = %s\n", settings.flick_stick_enabled ? "true" : "false");
-	fprintf(file, "flick_stick_calibrated = %s\n", settings.flick_stick_calibrated ? "true" : "false");
-	fprintf(file, "flick_stick_value = %f\n", settings.flick_stick_calibration_value);
+	fputs(text, file);
 
 	fclose(file);
 	settings_are_dirty = false;
@@ -137,18 +290,12 @@ void SaveSettings(const char* profile_name) {
 }
 
 bool LoadSettings(const char* profile_name) {
-	char dir_path[MAX_PATH];
-	if (!GetProfilesDir(dir_path, MAX_PATH)) {
+	char full_path[MAX_PATH];
+	if (!GetProfilePath(profile_name, full_path, MAX_PATH)) {
 		SDL_Log("Error: Could not determine profiles directory path for loading.");
 		return false;
 	}
 
-	char full_path[MAX_PATH];
-	PathCombineA(full_path, dir_path, profile_name);
-	if (!PathMatchSpecA(full_path, "*.ini")) {
-		strcat_s(full_path, MAX_PATH, ".ini");
-	}
-
 	FILE* file;
 	if (fopen_s(&file, full_path, "r") != 0 || !file) {
 		SDL_Log("Info: No profile file found (%s).", full_path);
@@ -157,70 +304,15 @@ bool LoadSettings(const char* profile_name) {
 
 	SetDefaultSettings();
 
-	char line[256], key[64], value[192], aim_type[32] = "none";
+	char line[256], aim_type[32] = "none";
 	while (fgets(line, sizeof(line), file)) {
-		if (line[0] == '#' || line[0] == '\n' || line[0] == '\r' || line[0] == '[') continue;
-		if (sscanf_s(line, " %63[^= \t] = %191[^\n\r]", key, (unsigned)_countof(key), value, (unsigned)_countof(value)) != 2) continue;
-
-		char* end = value + strlen(value) - 1;
-		while (end > value && isspace((unsigned char)*end)) end--;
-		*(end + 1) = 0;
-
+		char *key, *value;
+		if (!SplitSettingLine(line, &key, &value)) continue;
 		if (_stricmp(key, "config_version") == 0) {
 			if (atoi(value) != CURRENT_CONFIG_VERSION) SDL_Log("Warning: Profile version mismatch in %s.", profile_name);
 		}
-		else if (_stricmp(key, "mouse_mode") == 0) {
-			settings.mouse_mode = (_stricmp(value, "true") == 0);
-		}
-		else if (_stricmp(key, "sensitivity") == 0) {
-			settings.sensitivity = (float)atof(value);
-		}
-		else if (_stricmp(key, "mouse_sensitivity") == 0) {
-			settings.mouse_sensitivity = (float)atof(value);
-		}
-		else if (_stricmp(key, "always_on_gyro") == 0) {
-			settings.always_on_gyro = (_stricmp(value, "true") == 0);
-		}
-		else if (_stricmp(key, "invert_gyro_x") == 0) {
-			settings.invert_gyro_x = (_stricmp(value, "true") == 0);
-		}
-		else if (_stricmp(key, "invert_gyro_y") == 0) {
-			settings.invert_gyro_y = (_stricmp(value, "true") == 0);
-		}
-		else if (_stricmp(key, "anti_deadzone") == 0) {
-			settings.anti_deathzone = (float)atof(value);
-		}
-		else if (_stricmp(key, "aim_input_type") == 0) {
-			strcpy_s(aim_type, sizeof(aim_type), value);
-		}
-		else if (_stricmp(key, "aim_input_value") == 0) {
-			if (_stricmp(aim_type, "button") == 0) {
-				settings.selected_button = GamepadButtonFromString(value); settings.selected_axis = -1;
-			}
-			else if (_stricmp(aim_type, "axis") == 0) {
-				settings.selected_axis = GamepadAxisFromString(value); settings.selected_button = -1;
-			}
-		}
-		else if (_stricmp(key, "led_color") == 0) {
-			ParseHexColor(value, &settings.led_r, &settings.led_g, &settings.led_b);
-		}
-		else if (_stricmp(key, "gyro_offset_pitch") == 0) {
-			settings.gyro_calibration_offset[0] = (float)atof(value);
-		}
-		else if (_stricmp(key, "gyro_offset_yaw") == 0) {
-			settings.gyro_calibration_offset[1] = (float)atof(value);
-		}
-		else if (_stricmp(key, "gyro_offset_roll") == 0) {
-			settings.gyro_calibration_offset[2] = (float)atof(value);
-		}
-		else if (_stricmp(key, "flick_stick_enabled") == 0) {
-			settings.flick_stick_enabled = (_stricmp(value, "true") == 0);
-		}
-		else if (_stricmp(key, "flick_stick_calibrated") == 0) {
-			settings.flick_stick_calibrated = (_stricmp(value, "true") == 0);
-		}
-		else if (_stricmp(key, "flick_stick_value") == 0) {
-			settings.flick_stick_calibration_value = (float)atof(value);
+		else {
+			ApplySetting(&settings, key, value, aim_type, sizeof(aim_type));
 		}
 	}
 	fclose(file);
@@ -230,7 +322,7 @@ bool LoadSettings(const char* profile_name) {
 	settings_are_dirty = false;
 	char profile_name_no_ext[64];
 	strcpy_s(profile_name_no_ext, sizeof(profile_name_no_ext), profile_name);
-	PathRemoveExtensionA(profile_name_no_ext);
+	if (HasIniExtension(profile_name_no_ext)) *strrchr(profile_name_no_ext, '.') = 0;
 	strcpy_s(current_profile_name, sizeof(current_profile_name), profile_name_no_ext);
 	SDL_Log("Settings loaded successfully from %s.", full_path);
 	return true;
@@ -245,4 +337,18 @@ void UpdatePhysicalControllerLED(void)
 	else {
 		SDL_Log("Successfully set physical gamepad LED to #%02X%02X%02X", settings.led_r, settings.led_g, settings.led_b);
 	}
+}
+
+void BuildCoreConfig(const AppSettings* source, CoreConfig* config) {
+	config->gyro_offset[0] = source->gyro_calibration_offset[0];
+	config->gyro_offset[1] = source->gyro_calibration_offset[1];
+	config->gyro_offset[2] = source->gyro_calibration_offset[2];
+	config->mouse_sensitivity = source->mouse_sensitivity;
+	config->stick_sensitivity = source->sensitivity;
+	config->flick_counts_per_turn = source->flick_stick_calibration_value;
+	config->invert_x = source->invert_gyro_x;
+	config->invert_y = source->invert_gyro_y;
+	config->mouse_mode = source->mouse_mode;
+	config->flick_stick_enabled = source->flick_stick_enabled;
+	config->always_on_gyro = source->always_on_gyro;
 }
\ No newline at end of file
@@ -3,9 +3,15 @@
 
 #include "state.h"
 
+bool GetProfilesDir(char* path_buffer, size_t buffer_size);
 void SetDefaultSettings(void);
 void SaveSettings(const char* profile_name);
 bool LoadSettings(const char* profile_name);
+// Settings as the key = value lines of a profile, without the header. Exact writes floats that parse back to the
+// same bits, for capture files. Returns buffer_size or more if the text did not fit.
+size_t FormatSettings(const AppSettings* source, bool exact, char* buffer, size_t buffer_size);
+void ParseSettings(AppSettings* target, const char* text, size_t length); // Keys that are missing keep their defaults
 void UpdatePhysicalControllerLED(void);
+void BuildCoreConfig(const AppSettings* source, CoreConfig* config); // The tuning the processing core reads
 
 #endif
\ No newline at end of file
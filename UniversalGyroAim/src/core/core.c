@@ -0,0 +1,212 @@
+#include "core.h"
+#include <math.h>
+#include <stdlib.h>
+
+#define CORE_PI 3.14159265358979323846
+#define FLICK_STICK_DEADZONE 28000.0f
+#define STICK_IN_USE_THRESHOLD 8000.0f // Right stick deflection that takes over from gyro in the standard modes
+#define STICK_GYRO_SCALE 10000.0f // Stick units per rad/s at sensitivity 1 in joystick mode
+#define FLICK_CALIBRATION_TURN_SPEED 0.15f // Fraction of the remaining calibration turn sent per frame
+
+#define CORE_CLAMP(v, min, max) (((v) < (min)) ? (min) : (((v) > (max)) ? (max) : (v)))
+
+// --- XUSB button for each CoreButton; 0 for buttons the Xbox 360 pad does not have ---
+static const uint16_t xusb_button_map[CORE_BUTTON_COUNT] = {
+	[CORE_BUTTON_SOUTH] = CORE_XUSB_A,
+	[CORE_BUTTON_EAST] = CORE_XUSB_B,
+	[CORE_BUTTON_WEST] = CORE_XUSB_X,
+	[CORE_BUTTON_NORTH] = CORE_XUSB_Y,
+	[CORE_BUTTON_BACK] = CORE_XUSB_BACK,
+	[CORE_BUTTON_GUIDE] = CORE_XUSB_GUIDE,
+	[CORE_BUTTON_START] = CORE_XUSB_START,
+	[CORE_BUTTON_LEFT_STICK] = CORE_XUSB_LEFT_THUMB,
+	[CORE_BUTTON_RIGHT_STICK] = CORE_XUSB_RIGHT_THUMB,
+	[CORE_BUTTON_LEFT_SHOULDER] = CORE_XUSB_LEFT_SHOULDER,
+	[CORE_BUTTON_RIGHT_SHOULDER] = CORE_XUSB_RIGHT_SHOULDER,
+	[CORE_BUTTON_DPAD_UP] = CORE_XUSB_DPAD_UP,
+	[CORE_BUTTON_DPAD_DOWN] = CORE_XUSB_DPAD_DOWN,
+	[CORE_BUTTON_DPAD_LEFT] = CORE_XUSB_DPAD_LEFT,
+	[CORE_BUTTON_DPAD_RIGHT] = CORE_XUSB_DPAD_RIGHT
+};
+
+// --- Calibration ---
+void Core_CalibrationReset(CoreCalibration* calibration)
+{
+	calibration->sum[0] = 0.0f; calibration->sum[1] = 0.0f; calibration->sum[2] = 0.0f;
+	calibration->sample_count = 0;
+}
+
+void Core_CalibrationAddSample(CoreCalibration* calibration, const float data[3])
+{
+	calibration->sum[0] += data[0];
+	calibration->sum[1] += data[1];
+	calibration->sum[2] += data[2];
+	calibration->sample_count++;
+}
+
+bool Core_CalibrationFinish(const CoreCalibration* calibration, int samples_needed, float offset[3])
+{
+	if (calibration->sample_count < samples_needed) return false;
+	offset[0] = calibration->sum[0] / samples_needed;
+	offset[1] = calibration->sum[1] / samples_needed;
+	offset[2] = calibration->sum[2] / samples_needed;
+	return true;
+}
+
+bool Core_GyroIsStable(const float data[3], float threshold)
+{
+	return fabsf(data[0]) < threshold && fabsf(data[1]) < threshold && fabsf(data[2]) < threshold;
+}
+
+float Core_FlickCalibrationStep(float* turn_remaining)
+{
+	float turn_amount = *turn_remaining * FLICK_CALIBRATION_TURN_SPEED;
+	if (fabsf(*turn_remaining) < 1.0f) turn_amount = *turn_remaining;
+	*turn_remaining -= turn_amount;
+	return turn_amount;
+}
+
+// --- Gyro Scaling ---
+void Core_ApplyGyroOffset(const CoreConfig* config, const float raw[3], float calibrated[3])
+{
+	calibrated[0] = raw[0] - config->gyro_offset[0];
+	calibrated[1] = raw[1] - config->gyro_offset[1];
+	calibrated[2] = raw[2] - config->gyro_offset[2];
+}
+
+// Rotation covered by one sample, in mouse counts, integrated over the sample's own interval.
+void Core_IntegrateGyro(const CoreConfig* config, const float rate[3], float dt, float* delta_x, float* delta_y)
+{
+	*delta_x += rate[1] * dt * config->mouse_sensitivity * (config->invert_x ? 1.0f : -1.0f);
+	*delta_y += rate[0] * dt * config->mouse_sensitivity * (config->invert_y ? 1.0f : -1.0f);
+}
+
+// --- Flick Stick ---
+// Pushing past the deadzone turns to face the stick direction; rotating it after that turns by the change in angle.
+float Core_FlickStickUpdate(CoreFlickStick* flick, const CoreConfig* config, int16_t rx, int16_t ry)
+{
+	float stick_magnitude = sqrtf((float)rx * rx + (float)ry * ry);
+	if (stick_magnitude <= FLICK_STICK_DEADZONE) {
+		flick->active = false;
+		return 0.0f;
+	}
+
+	float output = 0.0f;
+	float current_angle = atan2f((float)-ry, (float)rx);
+	if (!flick->active) {
+		flick->active = true;
+		float flick_angle = current_angle - ((float)CORE_PI / 2.0f);
+		while (flick_angle <= -(float)CORE_PI) flick_angle += (2.0f * (float)CORE_PI);
+		while (flick_angle > (float)CORE_PI) flick_angle -= (2.0f * (float)CORE_PI);
+		output = -(flick_angle / (float)CORE_PI) * (config->flick_counts_per_turn / 2.0f);
+	}
+	else {
+		float delta_angle = current_angle - flick->last_angle;
+		if (delta_angle > CORE_PI) delta_angle -= (2.0f * (float)CORE_PI);
+		if (delta_angle < -CORE_PI) delta_angle += (2.0f * (float)CORE_PI);
+		output = -(delta_angle / (2.0f * (float)CORE_PI)) * config->flick_counts_per_turn;
+	}
+	flick->last_angle = current_angle;
+	return output;
+}
+
+// --- Stick Mixing ---
+bool Core_StickInUse(int16_t rx, int16_t ry)
+{
+	return sqrtf((float)rx * rx + (float)ry * ry) > STICK_IN_USE_THRESHOLD;
+}
+
+// Joystick mode: the gyro rate, scaled, is added on top of the right stick's own deflection.
+void Core_MixGyroIntoStick(const CoreConfig* config, int16_t rx, int16_t ry, const float gyro[3], int16_t* out_x, int16_t* out_y)
+{
+	const float x_mult = config->invert_x ? STICK_GYRO_SCALE : -STICK_GYRO_SCALE;
+	const float y_mult = config->invert_y ? -STICK_GYRO_SCALE : STICK_GYRO_SCALE;
+	float combined_x = (float)rx + (gyro[1] * config->stick_sensitivity * x_mult);
+	float combined_y = (float)Core_InvertAxis(ry) + (gyro[0] * config->stick_sensitivity * y_mult);
+	*out_x = (int16_t)CORE_CLAMP(combined_x, -32767.0f, 32767.0f);
+	*out_y = (int16_t)CORE_CLAMP(combined_y, -32767.0f, 32767.0f);
+}
+
+// --- Sub-count Accumulation ---
+// Adds a tick's movement and takes out the whole counts, keeping the fraction for later ticks.
+void Core_SubCountAdd(CoreSubCount* accumulator, float delta_x, float delta_y, int32_t* move_x, int32_t* move_y)
+{
+	accumulator->x += delta_x;
+	accumulator->y += delta_y;
+
+	*move_x = 0; *move_y = 0;
+	if (fabsf(accumulator->x) >= 1.0f) {
+		*move_x = (int32_t)accumulator->x; accumulator->x -= *move_x;
+	}
+	if (fabsf(accumulator->y) >= 1.0f) {
+		*move_y = (int32_t)accumulator->y; accumulator->y -= *move_y;
+	}
+}
+
+int32_t Core_MouseStepCount(int32_t move_x, int32_t move_y, int32_t max_step)
+{
+	if (max_step <= 0) return 1;
+	int32_t distance = (abs(move_x) > abs(move_y)) ? abs(move_x) : abs(move_y);
+	return (distance + max_step - 1) / max_step;
+}
+
+// Step `step` of `steps` evenly spaced sub-steps; the steps always sum to the whole move.
+void Core_MouseStep(int32_t move_x, int32_t move_y, int32_t steps, int32_t step, int32_t* dx, int32_t* dy)
+{
+	*dx = move_x * (step + 1) / steps - move_x * step / steps;
+	*dy = move_y * (step + 1) / steps - move_y * step / steps;
+}
+
+// --- Report Building ---
+uint16_t Core_MapButtonsToXusb(uint32_t buttons)
+{
+	uint16_t xusb_buttons = 0;
+	for (int button = 0; buttons; ++button, buttons >>= 1) {
+		if (buttons & 1u) xusb_buttons |= xusb_button_map[button];
+	}
+	return xusb_buttons;
+}
+
+int16_t Core_InvertAxis(int16_t value)
+{
+	return (value == -32768) ? 32767 : (int16_t)-value;
+}
+
+void Core_BuildReport(const CoreConfig* config, const CorePadState* pad, const float gyro[3], bool aiming, bool calibrating,
+	CoreFlickStick* flick, CoreReportResult* result)
+{
+	CorePadReport* report = &result->report;
+	*report = (CorePadReport){ 0 };
+	result->mouse_aim_active = false;
+	result->flick_delta = 0.0f;
+
+	if (!calibrating) {
+		report->buttons = Core_MapButtonsToXusb(pad->buttons);
+		report->left_trigger = (uint8_t)((pad->axes[CORE_AXIS_LEFT_TRIGGER] * 255) / 32767);
+		report->right_trigger = (uint8_t)((pad->axes[CORE_AXIS_RIGHT_TRIGGER] * 255) / 32767);
+		report->thumb_lx = pad->axes[CORE_AXIS_LEFTX];
+		report->thumb_ly = Core_InvertAxis(pad->axes[CORE_AXIS_LEFTY]);
+	}
+
+	bool gyro_is_active = (aiming || config->always_on_gyro) && !calibrating;
+	int16_t rx = pad->axes[CORE_AXIS_RIGHTX];
+	int16_t ry = pad->axes[CORE_AXIS_RIGHTY];
+
+	if (config->flick_stick_enabled) {
+		// The right stick is consumed by the flick stick and never reaches the virtual pad.
+		result->flick_delta = Core_FlickStickUpdate(flick, config, rx, ry);
+		result->mouse_aim_active = gyro_is_active;
+		return;
+	}
+
+	bool use_gyro_for_aim = gyro_is_active && !Core_StickInUse(rx, ry);
+	report->thumb_rx = rx;
+	report->thumb_ry = Core_InvertAxis(ry);
+
+	if (config->mouse_mode) {
+		result->mouse_aim_active = use_gyro_for_aim;
+	}
+	else if (use_gyro_for_aim) {
+		Core_MixGyroIntoStick(config, rx, ry, gyro, &report->thumb_rx, &report->thumb_ry);
+	}
+}
\ No newline at end of file
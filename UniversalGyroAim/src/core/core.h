@@ -0,0 +1,125 @@
+#ifndef CORE_H
+#define CORE_H
+
+// Platform-free processing core: calibration, gyro scaling, flick stick, stick mixing, sub-count accumulation
+// and report building. Depends only on the C standard library and keeps no state of its own; callers own every
+// state struct. The SDL, ViGEm, uinput and SendInput adapters live in the rest of src/.
+#include <stdint.h>
+#include <stdbool.h>
+
+// --- Pad Input: indices match SDL_GamepadButton and SDL_GamepadAxis (asserted in input.c) ---
+typedef enum {
+	CORE_BUTTON_SOUTH, CORE_BUTTON_EAST, CORE_BUTTON_WEST, CORE_BUTTON_NORTH,
+	CORE_BUTTON_BACK, CORE_BUTTON_GUIDE, CORE_BUTTON_START,
+	CORE_BUTTON_LEFT_STICK, CORE_BUTTON_RIGHT_STICK, CORE_BUTTON_LEFT_SHOULDER, CORE_BUTTON_RIGHT_SHOULDER,
+	CORE_BUTTON_DPAD_UP, CORE_BUTTON_DPAD_DOWN, CORE_BUTTON_DPAD_LEFT, CORE_BUTTON_DPAD_RIGHT,
+	CORE_BUTTON_COUNT = 26 // Including the paddles, touchpad and misc buttons, which have no XUSB equivalent
+} CoreButton;
+
+typedef enum {
+	CORE_AXIS_LEFTX, CORE_AXIS_LEFTY, CORE_AXIS_RIGHTX, CORE_AXIS_RIGHTY,
+	CORE_AXIS_LEFT_TRIGGER, CORE_AXIS_RIGHT_TRIGGER,
+	CORE_AXIS_COUNT
+} CoreAxis;
+
+typedef struct {
+	uint32_t buttons; // Bit n set while CoreButton n is held
+	int16_t axes[CORE_AXIS_COUNT];
+} CorePadState;
+
+// --- Xbox 360 report: same layout and button bits as XUSB_REPORT ---
+#define CORE_XUSB_DPAD_UP        0x0001
+#define CORE_XUSB_DPAD_DOWN      0x0002
+#define CORE_XUSB_DPAD_LEFT      0x0004
+#define CORE_XUSB_DPAD_RIGHT     0x0008
+#define CORE_XUSB_START          0x0010
+#define CORE_XUSB_BACK           0x0020
+#define CORE_XUSB_LEFT_THUMB     0x0040
+#define CORE_XUSB_RIGHT_THUMB    0x0080
+#define CORE_XUSB_LEFT_SHOULDER  0x0100
+#define CORE_XUSB_RIGHT_SHOULDER 0x0200
+#define CORE_XUSB_GUIDE          0x0400
+#define CORE_XUSB_A              0x1000
+#define CORE_XUSB_B              0x2000
+#define CORE_XUSB_X              0x4000
+#define CORE_XUSB_Y              0x8000
+
+typedef struct {
+	uint16_t buttons;
+	uint8_t left_trigger;
+	uint8_t right_trigger;
+	int16_t thumb_lx;
+	int16_t thumb_ly;
+	int16_t thumb_rx;
+	int16_t thumb_ry;
+} CorePadReport;
+
+// --- Tuning: the subset of AppSettings the processing reads ---
+typedef struct {
+	float gyro_offset[3]; // Subtracted from each raw sample (pitch, yaw, roll)
+	float mouse_sensitivity; // Mouse counts per radian
+	float stick_sensitivity; // Joystick mode gain
+	float flick_counts_per_turn; // Mouse counts for a 360 turn
+	bool invert_x;
+	bool invert_y;
+	bool mouse_mode;
+	bool flick_stick_enabled;
+	bool always_on_gyro;
+} CoreConfig;
+
+// --- Calibration ---
+typedef struct {
+	float sum[3];
+	int sample_count;
+} CoreCalibration;
+
+// --- Flick Stick ---
+typedef struct {
+	bool active; // Stick is past the deadzone; the next update turns by the change in angle
+	float last_angle;
+} CoreFlickStick;
+
+// --- Sub-count Accumulation ---
+typedef struct {
+	float x; // Fractional counts carried over to the next tick
+	float y;
+} CoreSubCount;
+
+// --- One report's worth of processing ---
+typedef struct {
+	CorePadReport report;
+	bool mouse_aim_active; // Gyro should drive the mouse path
+	float flick_delta; // Horizontal mouse counts the flick stick turned by
+} CoreReportResult;
+
+// --- Calibration ---
+void Core_CalibrationReset(CoreCalibration* calibration);
+void Core_CalibrationAddSample(CoreCalibration* calibration, const float data[3]);
+bool Core_CalibrationFinish(const CoreCalibration* calibration, int samples_needed, float offset[3]); // False until enough samples
+bool Core_GyroIsStable(const float data[3], float threshold); // Every axis below the threshold, uncalibrated
+float Core_FlickCalibrationStep(float* turn_remaining); // Next slice of the calibration turn, eased out
+
+// --- Gyro Scaling ---
+void Core_ApplyGyroOffset(const CoreConfig* config, const float raw[3], float calibrated[3]);
+void Core_IntegrateGyro(const CoreConfig* config, const float rate[3], float dt, float* delta_x, float* delta_y);
+
+// --- Flick Stick ---
+float Core_FlickStickUpdate(CoreFlickStick* flick, const CoreConfig* config, int16_t rx, int16_t ry);
+
+// --- Stick Mixing ---
+bool Core_StickInUse(int16_t rx, int16_t ry);
+void Core_MixGyroIntoStick(const CoreConfig* config, int16_t rx, int16_t ry, const float gyro[3], int16_t* out_x, int16_t* out_y);
+
+// --- Sub-count Accumulation ---
+void Core_SubCountAdd(CoreSubCount* accumulator, float delta_x, float delta_y, int32_t* move_x, int32_t* move_y);
+int32_t Core_MouseStepCount(int32_t move_x, int32_t move_y, int32_t max_step); // 1 when max_step is 0
+void Core_MouseStep(int32_t move_x, int32_t move_y, int32_t steps, int32_t step, int32_t* dx, int32_t* dy);
+
+// --- Report Building ---
+uint16_t Core_MapButtonsToXusb(uint32_t buttons);
+int16_t Core_InvertAxis(int16_t value); // SDL Y axes point down, XUSB up
+// Builds a report from the pad state. While calibrating only the right stick passes through and gyro stays off.
+void Core_BuildReport(const CoreConfig* config, const CorePadState* pad, const float gyro[3], bool aiming, bool calibrating,
+	CoreFlickStick* flick, CoreReportResult* result);
+
+#endif
\ No newline at end of file
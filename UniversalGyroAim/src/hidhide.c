@@ -1,4 +1,9 @@
 #include "hidhide.h"
+#include "trace.h"
+#include "wakeup.h"
+
+#ifdef _WIN32
+
 #include <shlwapi.h>
 #pragma comment(lib, "shlwapi.lib")
 #include <ShlObj.h>
@@ -6,6 +11,15 @@
 
 static wchar_t hid_hide_cli_path[MAX_PATH] = { 0 };
 
+// --- Worker: each CLI call starts a process and waits for it, so requests only record the wanted state ---
+static SDL_Mutex* request_lock = NULL; // Guards the request and the CLI path cache
+static SDL_Thread* hidhide_thread = NULL;
+static Wakeup hidhide_wakeup = WAKEUP_NONE;
+static volatile bool run_hidhide_thread = false;
+static bool hide_requested = false;
+static char requested_device_path[MAX_PATH] = { 0 }; // SDL path of the pad to hide, taken when it was requested
+static char hidden_gamepad_path[MAX_PATH] = { 0 }; // Worker only: SDL path of the pad that is hidden
+
 static bool ExecuteCommand(const wchar_t* command)
 {
 	STARTUPINFOW si;
@@ -19,6 +33,7 @@ static bool ExecuteCommand(const wchar_t* command)
 	wchar_t* cmd_mutable = _wcsdup(command);
 	if (!cmd_mutable) return false;
 
+	TRACE_BEGIN("HidHide ExecuteCommand");
 	if (CreateProcessW(NULL, cmd_mutable, NULL, NULL, FALSE, CREATE_NO_WINDOW, NULL, NULL, &si, &pi)) {
 		WaitForSingleObject(pi.hProcess, INFINITE);
 		GetExitCodeProcess(pi.hProcess, &exit_code);
@@ -28,6 +43,7 @@ static bool ExecuteCommand(const wchar_t* command)
 	else {
 		SDL_Log("CreateProcess failed (%lu) for command: %ls", GetLastError(), command);
 	}
+	TRACE_END("HidHide ExecuteCommand");
 	free(cmd_mutable);
 	return (exit_code == 0);
 }
@@ -61,7 +77,7 @@ static char* ConvertSymbolicLinkToDeviceInstancePath(const char* symbolic_link)
 	return instance_path;
 }
 
-static bool GetHidHideCliPath(wchar_t* cli_path, size_t cli_path_size)
+static bool FindHidHideCliPath(wchar_t* cli_path, size_t cli_path_size)
 {
 	if (hid_hide_cli_path[0] != L'\0') {
 		wcscpy_s(cli_path, cli_path_size, hid_hide_cli_path);
@@ -91,14 +107,22 @@ static bool GetHidHideCliPath(wchar_t* cli_path, size_t cli_path_size)
 	return false;
 }
 
+static bool GetHidHideCliPath(wchar_t* cli_path, size_t cli_path_size)
+{
+	if (request_lock) SDL_LockMutex(request_lock);
+	bool found = FindHidHideCliPath(cli_path, cli_path_size);
+	if (request_lock) SDL_UnlockMutex(request_lock);
+	return found;
+}
+
 bool IsHidHideAvailable(void) {
 	wchar_t cli_path_buffer[MAX_PATH];
 	return GetHidHideCliPath(cli_path_buffer, MAX_PATH);
 }
 
-void UnhidePhysicalController(void)
+static void UnhideDevice(void)
 {
-	if (!is_controller_hidden || hidden_device_instance_path[0] == L'\0') return;
+	if (!SDL_GetAtomicInt(&is_controller_hidden) || hidden_device_instance_path[0] == L'\0') return;
 	wchar_t cli_path[MAX_PATH];
 	if (!GetHidHideCliPath(cli_path, MAX_PATH)) return;
 
@@ -108,24 +132,24 @@ void UnhidePhysicalController(void)
 	SDL_Log("Attempting to unhide controller...");
 	if (ExecuteCommand(command)) {
 		SDL_Log("Physical controller successfully unhidden.");
-		is_controller_hidden = false;
+		SDL_SetAtomicInt(&is_controller_hidden, 0);
 		hidden_device_instance_path[0] = L'\0';
+		hidden_gamepad_path[0] = '\0';
 	}
 	else {
 		SDL_Log("Failed to unhide physical controller.");
 	}
 }
 
-void HidePhysicalController(SDL_Gamepad* pad_to_hide)
+static void HideDevice(const char* gamepad_path)
 {
-	if (is_controller_hidden) return;
-	if (!pad_to_hide) return;
+	if (SDL_GetAtomicInt(&is_controller_hidden)) return;
 
 	wchar_t cli_path[MAX_PATH];
 	if (!GetHidHideCliPath(cli_path, MAX_PATH)) return;
 
 	wchar_t command[1024];
-	const char* dev_path = ConvertSymbolicLinkToDeviceInstancePath(SDL_GetGamepadPath(pad_to_hide));
+	const char* dev_path = ConvertSymbolicLinkToDeviceInstancePath(gamepad_path);
 	if (!dev_path) return;
 
 	if (MultiByteToWideChar(CP_UTF8, 0, dev_path, -1, hidden_device_instance_path, MAX_PATH) == 0) {
@@ -144,11 +168,100 @@ void HidePhysicalController(SDL_Gamepad* pad_to_hide)
 
 	swprintf_s(command, 1024, L"\"%s\" --enable", cli_path);
 	if (ExecuteCommand(command)) {
-		is_controller_hidden = true;
 		SDL_Log("Successfully hid physical controller.");
 	}
 	else {
-		is_controller_hidden = true;
 		SDL_Log("Failed to enable HidHide service, but device may still be hidden.");
 	}
-}
\ No newline at end of file
+	strcpy_s(hidden_gamepad_path, sizeof(hidden_gamepad_path), gamepad_path);
+	SDL_SetAtomicInt(&is_controller_hidden, 1);
+}
+
+// Brings the driver to the last requested state; requests made meanwhile are picked up on the next pass.
+static void ApplyRequest(void)
+{
+	char device_path[MAX_PATH];
+	SDL_LockMutex(request_lock);
+	bool hide = hide_requested;
+	strcpy_s(device_path, sizeof(device_path), requested_device_path);
+	SDL_UnlockMutex(request_lock);
+
+	// A pad swapped for another before the worker ran: give the old one back first.
+	if (!hide || strcmp(device_path, hidden_gamepad_path) != 0) UnhideDevice();
+	if (hide && device_path[0]) HideDevice(device_path);
+}
+
+static int SDLCALL HidHideThread(void* data)
+{
+	TRACE_THREAD("HidHideThread");
+	while (run_hidhide_thread) {
+		ApplyRequest();
+		Wakeup_Wait(&hidhide_wakeup, -1);
+	}
+	return 0;
+}
+
+bool HidHide_StartThread(void)
+{
+	request_lock = SDL_CreateMutex();
+	if (!request_lock || !Wakeup_Init(&hidhide_wakeup)) {
+		SDL_Log("Error: Could not create the HidHide worker state.");
+		HidHide_StopThread();
+		return false;
+	}
+	run_hidhide_thread = true;
+	hidhide_thread = SDL_CreateThread(HidHideThread, "HidHideThread", NULL);
+	if (!hidhide_thread) {
+		SDL_Log("Error: Could not create the HidHide thread: %s", SDL_GetError());
+		HidHide_StopThread();
+		return false;
+	}
+	return true;
+}
+
+void HidHide_StopThread(void)
+{
+	if (hidhide_thread) {
+		run_hidhide_thread = false;
+		Wakeup_Signal(&hidhide_wakeup);
+		SDL_WaitThread(hidhide_thread, NULL);
+		hidhide_thread = NULL;
+	}
+	UnhideDevice(); // Nothing else runs the CLI any more, so the exit path can wait for it
+	Wakeup_Destroy(&hidhide_wakeup);
+	if (request_lock) SDL_DestroyMutex(request_lock);
+	request_lock = NULL;
+}
+
+static void Request(bool hide, const char* gamepad_path)
+{
+	if (!request_lock) return;
+	SDL_LockMutex(request_lock);
+	hide_requested = hide;
+	strcpy_s(requested_device_path, sizeof(requested_device_path), gamepad_path ? gamepad_path : "");
+	SDL_UnlockMutex(request_lock);
+	Wakeup_Signal(&hidhide_wakeup);
+}
+
+void HidePhysicalController(SDL_Gamepad* pad_to_hide)
+{
+	if (!pad_to_hide) return;
+	const char* gamepad_path = SDL_GetGamepadPath(pad_to_hide);
+	if (gamepad_path) Request(true, gamepad_path);
+}
+
+void UnhidePhysicalController(void)
+{
+	Request(false, NULL);
+}
+
+#else
+
+// HidHide is a Windows driver; elsewhere the physical controller is left visible.
+bool IsHidHideAvailable(void) { return false; }
+bool HidHide_StartThread(void) { return true; }
+void HidHide_StopThread(void) {}
+void UnhidePhysicalController(void) {}
+void HidePhysicalController(SDL_Gamepad* pad_to_hide) { (void)pad_to_hide; }
+
+#endif
\ No newline at end of file
@@ -3,6 +3,10 @@
 
 #include "state.h"
 
+// The HidHide CLI runs on a worker thread, as each call waits for a process. Hide and unhide record the wanted
+// state and return at once; the pad's path is taken right away, so it may be closed after the call.
+bool HidHide_StartThread(void);
+void HidHide_StopThread(void); // Unhides the controller before returning
 void HidePhysicalController(SDL_Gamepad* pad_to_hide);
 void UnhidePhysicalController(void);
 bool IsHidHideAvailable(void);
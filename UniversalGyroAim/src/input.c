@@ -1,11 +1,51 @@
 #include "input.h"
 #include "hidhide.h"
 #include "config.h"
+#include "shared.h"
+#include "output.h"
+#include "telemetry.h"
+#include "latency.h"
+#include "trace.h"
+#include "shm.h"
+#include "capture.h"
+#include "clock.h"
+#include "wakeup.h"
+#include "core/core.h"
 #include <math.h>
 
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
+// The core indexes pad state and reports by the SDL and XUSB layouts without including either.
+SDL_COMPILE_TIME_ASSERT(core_button_count, (int)CORE_BUTTON_COUNT == (int)SDL_GAMEPAD_BUTTON_COUNT);
+SDL_COMPILE_TIME_ASSERT(core_button_dpad_right, (int)CORE_BUTTON_DPAD_RIGHT == (int)SDL_GAMEPAD_BUTTON_DPAD_RIGHT);
+SDL_COMPILE_TIME_ASSERT(core_axis_count, (int)CORE_AXIS_COUNT == (int)SDL_GAMEPAD_AXIS_COUNT);
+SDL_COMPILE_TIME_ASSERT(core_axis_right_trigger, (int)CORE_AXIS_RIGHT_TRIGGER == (int)SDL_GAMEPAD_AXIS_RIGHT_TRIGGER);
+SDL_COMPILE_TIME_ASSERT(core_xusb_a, CORE_XUSB_A == XUSB_GAMEPAD_A);
+SDL_COMPILE_TIME_ASSERT(core_xusb_guide, CORE_XUSB_GUIDE == XUSB_GAMEPAD_GUIDE);
+SDL_COMPILE_TIME_ASSERT(core_report_size, sizeof(CorePadReport) == sizeof(XUSB_REPORT));
+
+static InputSnapshot published_snapshot;
+static AppSettings published_settings; // Byte copy of the settings in published_snapshot, for change detection
+static SDL_Mutex* snapshot_lock = NULL; // Held only to copy the snapshot, so readers never wait on an input update
+static Uint64 last_gyro_event_ns = 0; // For latency: newest gyro event not yet reflected in a report
+static Uint64 last_gyro_handler_ns = 0; // When that event's handler ran
+static bool pad_event_seen = false; // The last joystick update produced an event from the open pad
+
+Uint16 Input_MapButtonsToXusb(Uint32 buttons)
+{
+	return Core_MapButtonsToXusb(buttons);
+}
+
+// Seeds the pad state from the device, since inputs already held when it is opened produce no events.
+static void SyncPadState(void)
+{
+	SDL_zero(pad_state);
+	if (!gamepad) return;
+	for (int i = 0; i < SDL_GAMEPAD_BUTTON_COUNT; ++i) {
+		if (SDL_GetGamepadButton(gamepad, (SDL_GamepadButton)i)) pad_state.buttons |= 1u << i;
+	}
+	for (int i = 0; i < SDL_GAMEPAD_AXIS_COUNT; ++i) {
+		pad_state.axes[i] = SDL_GetGamepadAxis(gamepad, (SDL_GamepadAxis)i);
+	}
+}
 
 void Input_HandleGamepadAdded(SDL_Event* event)
 {
@@ -32,6 +72,11 @@ void Input_HandleGamepadAdded(SDL_Event* event)
 		else {
 			SDL_Log("Gyroscope enabled!");
 		}
+		float gyro_rate = SDL_GetGamepadSensorDataRate(gamepad, SDL_SENSOR_GYRO);
+		gyro_sample_interval_ns = (gyro_rate > 0.0f) ? (Uint64)(1e9f / gyro_rate) : GYRO_DEFAULT_SAMPLE_INTERVAL_NS;
+		last_gyro_sensor_timestamp = 0;
+		SyncPadState();
+		last_pad_packet_ns = 0;
 
 		SDL_PropertiesID props = SDL_GetGamepadProperties(gamepad);
 		controller_has_led = SDL_GetBooleanProperty(props, SDL_PROP_GAMEPAD_CAP_RGB_LED_BOOLEAN, false);
@@ -47,7 +92,7 @@ void Input_HandleGamepadAdded(SDL_Event* event)
 		SDL_Log("Ignoring additional controller: %s", SDL_GetGamepadName(temp_pad));
 		SDL_CloseGamepad(temp_pad);
 	}
-	force_one_render = true;
+	SDL_SetAtomicInt(&force_one_render, 1);
 }
 
 void Input_HandleGamepadRemoved(SDL_Event* event)
@@ -58,25 +103,28 @@ void Input_HandleGamepadRemoved(SDL_Event* event)
 		SDL_SetGamepadSensorEnabled(gamepad, SDL_SENSOR_GYRO, false);
 		SDL_CloseGamepad(gamepad);
 		gamepad = NULL;
+		SDL_zero(pad_state);
+		last_pad_packet_ns = 0;
 		controller_has_led = false;
-		force_one_render = true;
+		SDL_SetAtomicInt(&force_one_render, 1);
 		settings.selected_button = -1;
 		settings.selected_axis = -1;
 		isAiming = false;
 
-		EnterCriticalSection(&data_lock);
-		shared_mouse_aim_active = false;
-		shared_gyro_data[0] = 0.0f;
-		shared_gyro_data[1] = 0.0f;
-		shared_gyro_data[2] = 0.0f;
-		shared_flick_stick_delta_x = 0.0f;
-		LeaveCriticalSection(&data_lock);
+		Shared_SetMouseAimActive(false);
+		Shared_TakeFlickStickDelta();
 	}
 }
 
 void Input_HandleGamepadButton(SDL_Event* event)
 {
 	if (event->gbutton.which != gamepad_instance_id) return;
+	Capture_Button(event->common.timestamp, event->gbutton.button, event->gbutton.down);
+
+	if (event->gbutton.button < SDL_GAMEPAD_BUTTON_COUNT) {
+		if (event->gbutton.down) pad_state.buttons |= 1u << event->gbutton.button;
+		else pad_state.buttons &= ~(1u << event->gbutton.button);
+	}
 
 	if (is_waiting_for_aim_button && event->type == SDL_EVENT_GAMEPAD_BUTTON_DOWN) {
 		settings.selected_button = event->gbutton.button;
@@ -96,7 +144,7 @@ void Input_HandleGamepadButton(SDL_Event* event)
 			}
 			else if (event->gbutton.button == SDL_GAMEPAD_BUTTON_EAST) {
 				calibration_state = CALIBRATION_IDLE;
-				force_one_render = true;
+				SDL_SetAtomicInt(&force_one_render, 1);
 				button_handled = true;
 			}
 		}
@@ -114,7 +162,7 @@ void Input_HandleGamepadButton(SDL_Event* event)
 			else if (event->gbutton.button == SDL_GAMEPAD_BUTTON_EAST) {
 				settings.flick_stick_calibrated = true;
 				calibration_state = CALIBRATION_IDLE;
-				force_one_render = true;
+				SDL_SetAtomicInt(&force_one_render, 1);
 				settings_are_dirty = true;
 				SDL_Log("Flick Stick calibration saved. Value: %.2f", settings.flick_stick_calibration_value);
 			}
@@ -124,9 +172,8 @@ void Input_HandleGamepadButton(SDL_Event* event)
 			if (event->gbutton.button == SDL_GAMEPAD_BUTTON_EAST) {
 				calibration_state = CALIBRATION_IDLE;
 				stability_timer_start_time = 0;
-				calibration_sample_count = 0;
-				gyro_accumulator[0] = 0.0f; gyro_accumulator[1] = 0.0f; gyro_accumulator[2] = 0.0f;
-				force_one_render = true;
+				Core_CalibrationReset(&gyro_calibration);
+				SDL_SetAtomicInt(&force_one_render, 1);
 				SDL_Log("Gyro calibration cancelled by user.");
 				button_handled = true;
 			}
@@ -142,6 +189,9 @@ void Input_HandleGamepadButton(SDL_Event* event)
 void Input_HandleGamepadAxis(SDL_Event* event)
 {
 	if (event->gaxis.which != gamepad_instance_id) return;
+	Capture_Axis(event->common.timestamp, event->gaxis.axis, event->gaxis.value);
+
+	if (event->gaxis.axis < SDL_GAMEPAD_AXIS_COUNT) pad_state.axes[event->gaxis.axis] = event->gaxis.value;
 
 	if (is_waiting_for_aim_button) {
 		if ((event->gaxis.axis == SDL_GAMEPAD_AXIS_LEFT_TRIGGER || event->gaxis.axis == SDL_GAMEPAD_AXIS_RIGHT_TRIGGER) && event->gaxis.value > 8000) {
@@ -161,41 +211,53 @@ void Input_HandleGamepadAxis(SDL_Event* event)
 void Input_HandleGamepadSensor(SDL_Event* event)
 {
 	if (event->gsensor.sensor != SDL_SENSOR_GYRO) return;
+	TRACE_BEGIN("Input_HandleGamepadSensor");
+	Capture_Sensor(event->common.timestamp, event->gsensor.sensor_timestamp, event->gsensor.data); // Uncalibrated, as the pad sent it
+	last_gyro_event_ns = event->common.timestamp;
+	last_gyro_handler_ns = Clock_GetTicksNS();
+	Latency_Record(LATENCY_DISPATCH, last_gyro_handler_ns - event->common.timestamp);
+
+	// Each sample covers the time since the previous one, measured on the sensor's own clock when available.
+	Uint64 sensor_timestamp = event->gsensor.sensor_timestamp ? event->gsensor.sensor_timestamp : event->common.timestamp;
+	Uint64 interval_ns = gyro_sample_interval_ns;
+	if (last_gyro_sensor_timestamp != 0 && sensor_timestamp > last_gyro_sensor_timestamp) {
+		interval_ns = sensor_timestamp - last_gyro_sensor_timestamp;
+		if (interval_ns > GYRO_MAX_SAMPLE_INTERVAL_NS) interval_ns = GYRO_MAX_SAMPLE_INTERVAL_NS;
+	}
+	last_gyro_sensor_timestamp = sensor_timestamp;
 
 	switch (calibration_state) {
 	case CALIBRATION_IDLE:
 	{
-		float calibrated_data[3];
-		calibrated_data[0] = event->gsensor.data[0] - settings.gyro_calibration_offset[0];
-		calibrated_data[1] = event->gsensor.data[1] - settings.gyro_calibration_offset[1];
-		calibrated_data[2] = event->gsensor.data[2] - settings.gyro_calibration_offset[2];
-
-		EnterCriticalSection(&data_lock);
-		shared_gyro_data[0] = calibrated_data[0];
-		shared_gyro_data[1] = calibrated_data[1];
-		shared_gyro_data[2] = calibrated_data[2];
-		LeaveCriticalSection(&data_lock);
-
-		gyro_data[0] = calibrated_data[0];
-		gyro_data[1] = calibrated_data[1];
-		gyro_data[2] = calibrated_data[2];
+		CoreConfig config;
+		BuildCoreConfig(&settings, &config);
+		GyroSample sample;
+		Core_ApplyGyroOffset(&config, event->gsensor.data, sample.data);
+		sample.dt = (float)interval_ns / 1e9f;
+		sample.timestamp_ns = event->common.timestamp;
+		sample.sensor_timestamp_ns = sensor_timestamp;
+		if (Shared_IsMouseAimActive()) {
+			sample.handoff_ns = Clock_GetTicksNS();
+			if (Shared_PushGyroSample(&sample)) Latency_Record(LATENCY_MOUSE_HANDOFF, sample.handoff_ns - last_gyro_handler_ns);
+		}
+		Telemetry_PushGyroSample(sample.data, interval_ns);
+
+		gyro_data[0] = sample.data[0];
+		gyro_data[1] = sample.data[1];
+		gyro_data[2] = sample.data[2];
 		break;
 	}
 	case CALIBRATION_WAITING_FOR_STABILITY:
 	{
-		bool is_stable = fabsf(event->gsensor.data[0]) < GYRO_STABILITY_THRESHOLD &&
-			fabsf(event->gsensor.data[1]) < GYRO_STABILITY_THRESHOLD &&
-			fabsf(event->gsensor.data[2]) < GYRO_STABILITY_THRESHOLD;
-		if (is_stable) {
+		if (Core_GyroIsStable(event->gsensor.data, GYRO_STABILITY_THRESHOLD)) {
 			if (stability_timer_start_time == 0) {
-				stability_timer_start_time = SDL_GetPerformanceCounter();
+				stability_timer_start_time = Clock_GetTicksNS();
 			}
 			else {
-				Uint64 elapsed_ms = (SDL_GetPerformanceCounter() - stability_timer_start_time) * 1000 / SDL_GetPerformanceFrequency();
+				Uint64 elapsed_ms = SDL_NS_TO_MS(Clock_GetTicksNS() - stability_timer_start_time);
 				if (elapsed_ms >= GYRO_STABILITY_DURATION_MS) {
 					calibration_state = CALIBRATION_SAMPLING;
-					calibration_sample_count = 0;
-					gyro_accumulator[0] = 0.0f; gyro_accumulator[1] = 0.0f; gyro_accumulator[2] = 0.0f;
+					Core_CalibrationReset(&gyro_calibration);
 					SDL_Log("Controller is stable. Starting data collection...");
 				}
 			}
@@ -206,38 +268,25 @@ void Input_HandleGamepadSensor(SDL_Event* event)
 		break;
 	}
 	case CALIBRATION_SAMPLING:
-		gyro_accumulator[0] += event->gsensor.data[0];
-		gyro_accumulator[1] += event->gsensor.data[1];
-		gyro_accumulator[2] += event->gsensor.data[2];
-		calibration_sample_count++;
+		Core_CalibrationAddSample(&gyro_calibration, event->gsensor.data);
 		break;
 	default: break;
 	}
+	TRACE_END("Input_HandleGamepadSensor");
 }
 
 void Input_UpdateCalibrationState(void)
 {
-	if (calibration_state == CALIBRATION_SAMPLING && calibration_sample_count >= CALIBRATION_SAMPLES) {
-		settings.gyro_calibration_offset[0] = gyro_accumulator[0] / CALIBRATION_SAMPLES;
-		settings.gyro_calibration_offset[1] = gyro_accumulator[1] / CALIBRATION_SAMPLES;
-		settings.gyro_calibration_offset[2] = gyro_accumulator[2] / CALIBRATION_SAMPLES;
+	if (calibration_state == CALIBRATION_SAMPLING && Core_CalibrationFinish(&gyro_calibration, CALIBRATION_SAMPLES, settings.gyro_calibration_offset)) {
 		calibration_state = CALIBRATION_IDLE;
-		force_one_render = true;
+		SDL_SetAtomicInt(&force_one_render, 1);
 		settings_are_dirty = true;
 		SDL_Log("Calibration complete. Offsets saved -> Pitch: %.4f, Yaw: %.4f, Roll: %.4f",
 			settings.gyro_calibration_offset[0], settings.gyro_calibration_offset[1], settings.gyro_calibration_offset[2]);
 	}
 
 	if (calibration_state == FLICK_STICK_CALIBRATION_TURNING) {
-		const float TURN_SPEED_FACTOR = 0.15f;
-		float turn_amount = flick_stick_turn_remaining * TURN_SPEED_FACTOR;
-		if (fabsf(flick_stick_turn_remaining) < 1.0f) turn_amount = flick_stick_turn_remaining;
-
-		EnterCriticalSection(&data_lock);
-		shared_flick_stick_delta_x += turn_amount;
-		LeaveCriticalSection(&data_lock);
-
-		flick_stick_turn_remaining -= turn_amount;
+		Shared_AddFlickStickDelta(Core_FlickCalibrationStep(&flick_stick_turn_remaining));
 		if (fabsf(flick_stick_turn_remaining) < 0.1f) {
 			calibration_state = FLICK_STICK_CALIBRATION_ADJUST;
 		}
@@ -247,92 +296,204 @@ void Input_UpdateCalibrationState(void)
 void Input_ProcessAndPassthrough(XUSB_REPORT* report)
 {
 	if (!gamepad) return;
+	TRACE_BEGIN("Input_ProcessAndPassthrough");
+
+	CoreConfig config;
+	BuildCoreConfig(&settings, &config);
+	CoreReportResult result;
+	Core_BuildReport(&config, &pad_state, gyro_data, isAiming, calibration_state != CALIBRATION_IDLE, &flick_stick, &result);
+
+	report->wButtons = result.report.buttons;
+	report->bLeftTrigger = result.report.left_trigger;
+	report->bRightTrigger = result.report.right_trigger;
+	report->sThumbLX = result.report.thumb_lx;
+	report->sThumbLY = result.report.thumb_ly;
+	report->sThumbRX = result.report.thumb_rx;
+	report->sThumbRY = result.report.thumb_ry;
+
+	Shared_SetMouseAimActive(result.mouse_aim_active);
+	if (config.flick_stick_enabled) Shared_AddFlickStickDelta(result.flick_delta);
+	TRACE_END("Input_ProcessAndPassthrough");
+}
 
-	if (calibration_state == CALIBRATION_IDLE) {
-		if (SDL_GetGamepadButton(gamepad, SDL_GAMEPAD_BUTTON_SOUTH)) report->wButtons |= XUSB_GAMEPAD_A;
-		if (SDL_GetGamepadButton(gamepad, SDL_GAMEPAD_BUTTON_EAST)) report->wButtons |= XUSB_GAMEPAD_B;
-		if (SDL_GetGamepadButton(gamepad, SDL_GAMEPAD_BUTTON_WEST)) report->wButtons |= XUSB_GAMEPAD_X;
-		if (SDL_GetGamepadButton(gamepad, SDL_GAMEPAD_BUTTON_NORTH)) report->wButtons |= XUSB_GAMEPAD_Y;
-		if (SDL_GetGamepadButton(gamepad, SDL_GAMEPAD_BUTTON_LEFT_SHOULDER)) report->wButtons |= XUSB_GAMEPAD_LEFT_SHOULDER;
-		if (SDL_GetGamepadButton(gamepad, SDL_GAMEPAD_BUTTON_RIGHT_SHOULDER)) report->wButtons |= XUSB_GAMEPAD_RIGHT_SHOULDER;
-		if (SDL_GetGamepadButton(gamepad, SDL_GAMEPAD_BUTTON_BACK)) report->wButtons |= XUSB_GAMEPAD_BACK;
-		if (SDL_GetGamepadButton(gamepad, SDL_GAMEPAD_BUTTON_START)) report->wButtons |= XUSB_GAMEPAD_START;
-		if (SDL_GetGamepadButton(gamepad, SDL_GAMEPAD_BUTTON_LEFT_STICK)) report->wButtons |= XUSB_GAMEPAD_LEFT_THUMB;
-		if (SDL_GetGamepadButton(gamepad, SDL_GAMEPAD_BUTTON_RIGHT_STICK)) report->wButtons |= XUSB_GAMEPAD_RIGHT_THUMB;
-		if (SDL_GetGamepadButton(gamepad, SDL_GAMEPAD_BUTTON_DPAD_UP)) report->wButtons |= XUSB_GAMEPAD_DPAD_UP;
-		if (SDL_GetGamepadButton(gamepad, SDL_GAMEPAD_BUTTON_DPAD_DOWN)) report->wButtons |= XUSB_GAMEPAD_DPAD_DOWN;
-		if (SDL_GetGamepadButton(gamepad, SDL_GAMEPAD_BUTTON_DPAD_LEFT)) report->wButtons |= XUSB_GAMEPAD_DPAD_LEFT;
-		if (SDL_GetGamepadButton(gamepad, SDL_GAMEPAD_BUTTON_DPAD_RIGHT)) report->wButtons |= XUSB_GAMEPAD_DPAD_RIGHT;
-		if (SDL_GetGamepadButton(gamepad, SDL_GAMEPAD_BUTTON_GUIDE)) report->wButtons |= XUSB_GAMEPAD_GUIDE;
-
-		report->bLeftTrigger = (SDL_GetGamepadAxis(gamepad, SDL_GAMEPAD_AXIS_LEFT_TRIGGER) * 255) / 32767;
-		report->bRightTrigger = (SDL_GetGamepadAxis(gamepad, SDL_GAMEPAD_AXIS_RIGHT_TRIGGER) * 255) / 32767;
-
-		report->sThumbLX = SDL_GetGamepadAxis(gamepad, SDL_GAMEPAD_AXIS_LEFTX);
-		Sint16 ly = SDL_GetGamepadAxis(gamepad, SDL_GAMEPAD_AXIS_LEFTY);
-		report->sThumbLY = (ly == -32768) ? 32767 : -ly;
+static void BuildAndSubmitReport(void)
+{
+	static bool captured_aiming = false;
+	if (isAiming != captured_aiming) {
+		Capture_Aim(Clock_GetTicksNS(), isAiming);
+		captured_aiming = isAiming;
 	}
 
-	bool gyro_is_active = (isAiming || settings.always_on_gyro) && (calibration_state == CALIBRATION_IDLE);
-	Sint16 rx = SDL_GetGamepadAxis(gamepad, SDL_GAMEPAD_AXIS_RIGHTX);
-	Sint16 ry = SDL_GetGamepadAxis(gamepad, SDL_GAMEPAD_AXIS_RIGHTY);
-
-	if (settings.flick_stick_enabled) {
-		const float FLICK_STICK_DEADZONE = 28000.0f;
-		float stick_magnitude = sqrtf((float)rx * rx + (float)ry * ry);
-		float flick_stick_output_x = 0.0f;
-
-		if (stick_magnitude > FLICK_STICK_DEADZONE) {
-			float current_angle = atan2f((float)-ry, (float)rx);
-			if (!is_flick_stick_active) {
-				is_flick_stick_active = true;
-				float flick_angle = current_angle - ((float)M_PI / 2.0f);
-				while (flick_angle <= -(float)M_PI) flick_angle += (2.0f * (float)M_PI);
-				while (flick_angle > (float)M_PI) flick_angle -= (2.0f * (float)M_PI);
-				flick_stick_output_x = -(flick_angle / (float)M_PI) * (settings.flick_stick_calibration_value / 2.0f);
-			}
-			else {
-				float delta_angle = current_angle - flick_last_angle;
-				if (delta_angle > M_PI) delta_angle -= (2.0f * (float)M_PI);
-				if (delta_angle < -M_PI) delta_angle += (2.0f * (float)M_PI);
-				flick_stick_output_x = -(delta_angle / (2.0f * (float)M_PI)) * settings.flick_stick_calibration_value;
-			}
-			flick_last_angle = current_angle;
+	XUSB_REPORT report = { 0 };
+	Input_ProcessAndPassthrough(&report);
+	bool posted = Output_PadUpdate(&report, last_gyro_event_ns);
+
+	if (last_gyro_event_ns != 0) {
+		if (posted) Latency_Record(LATENCY_PAD_HANDOFF, Clock_GetTicksNS() - last_gyro_handler_ns);
+		Uint64 latency = Clock_GetTicksNS() - last_gyro_event_ns;
+		input_stats.reports++;
+		input_stats.latency_sum_ns += latency;
+		if (latency > input_stats.latency_max_ns) input_stats.latency_max_ns = latency;
+		if (!Shared_IsMouseAimActive()) Telemetry_SetLatency(latency); // In mouse mode the mouse thread reports its own
+		last_gyro_event_ns = 0;
+	}
+}
+
+// The pad finished delivering a packet: submit the report now rather than on the next frame.
+void Input_HandleGamepadUpdateComplete(SDL_Event* event)
+{
+	if (!gamepad || event->gdevice.which != gamepad_instance_id) return;
+	last_pad_packet_ns = Clock_GetTicksNS();
+	Capture_Packet(event->common.timestamp);
+	BuildAndSubmitReport();
+}
+
+// Frame-driven fallback for drivers that never send update-complete events, or while no pad is connected.
+void Input_SubmitFrameReport(void)
+{
+	if (last_pad_packet_ns != 0 && Clock_GetTicksNS() - last_pad_packet_ns < SDL_MS_TO_NS(PAD_PACKET_TIMEOUT_MS)) return;
+	BuildAndSubmitReport();
+}
+
+// --- Input Thread ---
+void Input_LockState(void)
+{
+	SDL_LockMutex(input_lock);
+}
+
+// Publishes the state changed under the lock before releasing it.
+void Input_UnlockState(void)
+{
+	InputSnapshot snapshot;
+	snapshot.settings = settings;
+	strcpy_s(snapshot.profile_name, sizeof(snapshot.profile_name), current_profile_name);
+	snapshot.settings_are_dirty = settings_are_dirty;
+	snapshot.has_gamepad = (gamepad != NULL);
+	snapshot.controller_has_led = controller_has_led;
+	snapshot.is_controller_hidden = SDL_GetAtomicInt(&is_controller_hidden) != 0;
+	snapshot.is_aiming = isAiming;
+	snapshot.is_waiting_for_aim_button = is_waiting_for_aim_button;
+	snapshot.calibration_state = calibration_state;
+	snapshot.calibration_sample_count = gyro_calibration.sample_count;
+	snapshot.stability_timer_start_time = stability_timer_start_time;
+	snapshot.gyro_data[0] = gyro_data[0]; snapshot.gyro_data[1] = gyro_data[1]; snapshot.gyro_data[2] = gyro_data[2];
+
+	bool changed = SDL_memcmp(&settings, &published_settings, sizeof(AppSettings)) != 0 ||
+		SDL_strcmp(snapshot.profile_name, published_snapshot.profile_name) != 0 ||
+		snapshot.settings_are_dirty != published_snapshot.settings_are_dirty ||
+		snapshot.has_gamepad != published_snapshot.has_gamepad ||
+		snapshot.controller_has_led != published_snapshot.controller_has_led ||
+		snapshot.is_controller_hidden != published_snapshot.is_controller_hidden ||
+		snapshot.is_waiting_for_aim_button != published_snapshot.is_waiting_for_aim_button ||
+		snapshot.calibration_state != published_snapshot.calibration_state ||
+		snapshot.calibration_sample_count != published_snapshot.calibration_sample_count ||
+		snapshot.stability_timer_start_time != published_snapshot.stability_timer_start_time;
+	snapshot.revision = published_snapshot.revision + (changed ? 1 : 0);
+	SDL_memcpy(&published_settings, &settings, sizeof(AppSettings));
+
+	SDL_LockMutex(snapshot_lock);
+	published_snapshot = snapshot;
+	SDL_UnlockMutex(snapshot_lock);
+	SDL_UnlockMutex(input_lock);
+}
+
+void Input_GetSnapshot(InputSnapshot* snapshot)
+{
+	SDL_LockMutex(snapshot_lock);
+	*snapshot = published_snapshot;
+	SDL_UnlockMutex(snapshot_lock);
+}
+
+// Runs on whichever thread generated the event; after startup that is the input thread, inside SDL_UpdateJoysticks.
+static bool SDLCALL InputEventFilter(void* userdata, SDL_Event* event)
+{
+	if (event->type >= SDL_EVENT_GAMEPAD_AXIS_MOTION && event->type <= SDL_EVENT_GAMEPAD_UPDATE_COMPLETE &&
+		gamepad && event->gdevice.which == gamepad_instance_id) pad_event_seen = true;
+	switch (event->type) {
+	case SDL_EVENT_GAMEPAD_ADDED: Input_HandleGamepadAdded(event); return true; // Kept so the UI wakes up to redraw
+	case SDL_EVENT_GAMEPAD_REMOVED: Input_HandleGamepadRemoved(event); return true;
+	case SDL_EVENT_GAMEPAD_BUTTON_DOWN:
+	case SDL_EVENT_GAMEPAD_BUTTON_UP: Input_HandleGamepadButton(event); return false;
+	case SDL_EVENT_GAMEPAD_AXIS_MOTION: Input_HandleGamepadAxis(event); return false;
+	case SDL_EVENT_GAMEPAD_SENSOR_UPDATE: Input_HandleGamepadSensor(event); return false;
+	case SDL_EVENT_GAMEPAD_UPDATE_COMPLETE: Input_HandleGamepadUpdateComplete(event); return false;
+	}
+	// Raw joystick events duplicate the gamepad ones and would wake the main thread at the packet rate.
+	return !(event->type >= SDL_EVENT_JOYSTICK_AXIS_MOTION && event->type < SDL_EVENT_GAMEPAD_AXIS_MOTION);
+}
+
+static int SDLCALL InputThread(void* data)
+{
+	SDL_SetCurrentThreadPriority(SDL_THREAD_PRIORITY_HIGH);
+	TRACE_THREAD("InputThread");
+	SDL_zero(input_stats);
+	input_stats.start_ns = SDL_GetTicksNS();
+	Uint64 last_pad_event_ns = input_stats.start_ns;
+
+	while (run_input_thread) {
+		Input_LockState();
+		pad_event_seen = false;
+		SDL_UpdateJoysticks(); // Gamepad events are handled by InputEventFilter as they are generated
+		Input_UpdateCalibrationState();
+		Input_SubmitFrameReport();
+		Shm_Publish();
+		bool has_gamepad = (gamepad != NULL);
+		bool is_calibrating = (calibration_state != CALIBRATION_IDLE);
+		Input_UnlockState();
+		input_stats.polls++;
+
+		// A streaming pad is polled every millisecond. One that has gone quiet, e.g. with its sensors off, and the
+		// no-pad hotplug check block on the wakeup instead, so an idle input thread costs next to nothing.
+		Uint64 now = SDL_GetTicksNS();
+		if (pad_event_seen || is_calibrating) last_pad_event_ns = now;
+		if (has_gamepad && now - last_pad_event_ns < SDL_MS_TO_NS(INPUT_IDLE_AFTER_MS)) {
+			SDL_DelayNS(SDL_MS_TO_NS(INPUT_POLL_INTERVAL_MS));
 		}
 		else {
-			is_flick_stick_active = false;
+			Wakeup_Wait(&input_wakeup, has_gamepad ? INPUT_IDLE_POLL_INTERVAL_MS : PACING_IDLE_TIMEOUT_MS);
 		}
-
-		EnterCriticalSection(&data_lock);
-		shared_mouse_aim_active = gyro_is_active;
-		shared_flick_stick_delta_x += flick_stick_output_x;
-		LeaveCriticalSection(&data_lock);
-		report->sThumbRX = 0; report->sThumbRY = 0;
 	}
-	else { // Standard logic
-		bool stick_in_use = sqrtf((float)rx * rx + (float)ry * ry) > 8000.0f;
-		bool use_gyro_for_aim = gyro_is_active && !stick_in_use;
+	return 0;
+}
 
-		report->sThumbRX = rx;
-		report->sThumbRY = (ry == -32768) ? 32767 : -ry;
+// Requires SDL_HINT_AUTO_UPDATE_JOYSTICKS to be off so that only this thread updates joysticks.
+bool Input_StartThread(void)
+{
+	input_lock = SDL_CreateMutex();
+	snapshot_lock = SDL_CreateMutex();
+	if (!input_lock || !snapshot_lock || !Wakeup_Init(&input_wakeup)) {
+		SDL_Log("FATAL: Could not create input lock!");
+		return false;
+	}
+	Input_LockState();
+	Input_UnlockState(); // Publish the initial snapshot
+	SDL_SetEventFilter(InputEventFilter, NULL);
+
+	run_input_thread = true;
+	input_thread = SDL_CreateThread(InputThread, "InputThread", NULL);
+	if (input_thread) {
+		return true;
+	}
+	SDL_Log("FATAL: Could not create input thread!");
+	return false;
+}
 
-		if (settings.mouse_mode) {
-			EnterCriticalSection(&data_lock);
-			shared_mouse_aim_active = use_gyro_for_aim;
-			LeaveCriticalSection(&data_lock);
-		}
-		else { // Joystick Mode
-			EnterCriticalSection(&data_lock);
-			shared_mouse_aim_active = false;
-			LeaveCriticalSection(&data_lock);
-			if (use_gyro_for_aim) {
-				const float x_mult = settings.invert_gyro_x ? 10000.0f : -10000.0f;
-				const float y_mult = settings.invert_gyro_y ? -10000.0f : 10000.0f;
-				float combined_x = (float)rx + (gyro_data[1] * settings.sensitivity * x_mult);
-				float combined_y = ((ry == -32768) ? 32767.f : (float)-ry) + (gyro_data[0] * settings.sensitivity * y_mult);
-				report->sThumbRX = (short)CLAMP(combined_x, -32767.0f, 32767.0f);
-				report->sThumbRY = (short)CLAMP(combined_y, -32767.0f, 32767.0f);
-			}
-		}
+void Input_StopThread(void)
+{
+	if (input_thread) {
+		run_input_thread = false;
+		Wakeup_Signal(&input_wakeup);
+		SDL_WaitThread(input_thread, NULL);
+		input_thread = NULL;
+		SDL_SetEventFilter(NULL, NULL);
+		SDL_DestroyMutex(input_lock); input_lock = NULL;
+		SDL_DestroyMutex(snapshot_lock); snapshot_lock = NULL;
+
+		double seconds = (double)(SDL_GetTicksNS() - input_stats.start_ns) / 1e9;
+		SDL_Log("Input thread stopped (%s). %.1f polls/s, gyro-to-report latency avg %.3f ms / max %.3f ms over %llu reports.",
+			is_headless ? "headless" : "rendering", seconds > 0.0 ? input_stats.polls / seconds : 0.0,
+			input_stats.reports ? (double)input_stats.latency_sum_ns / input_stats.reports / 1e6 : 0.0,
+			input_stats.latency_max_ns / 1e6, (unsigned long long)input_stats.reports);
 	}
+	Wakeup_Destroy(&input_wakeup);
 }
\ No newline at end of file
@@ -8,7 +8,18 @@ void Input_HandleGamepadRemoved(SDL_Event* event);
 void Input_HandleGamepadButton(SDL_Event* event);
 void Input_HandleGamepadAxis(SDL_Event* event);
 void Input_HandleGamepadSensor(SDL_Event* event);
+void Input_HandleGamepadUpdateComplete(SDL_Event* event);
 void Input_UpdateCalibrationState(void);
+void Input_SubmitFrameReport(void);
+
+// Gamepad input runs on its own thread. The main thread takes the lock around anything that touches
+// input state; unlocking publishes the snapshot the UI renders from.
+bool Input_StartThread(void);
+void Input_StopThread(void);
+void Input_LockState(void);
+void Input_UnlockState(void);
+void Input_GetSnapshot(InputSnapshot* snapshot);
 void Input_ProcessAndPassthrough(XUSB_REPORT* report);
+Uint16 Input_MapButtonsToXusb(Uint32 buttons); // Packed SDL_GamepadButton bits to XUSB wButtons
 
 #endif
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include "latency.h"
+#include <stdio.h>
+
+static const char* latency_stage_names[LATENCY_STAGE_COUNT] = {
+	"sensor->handler",
+	"handler->mouse q",
+	"mouse q->emit",
+	"sensor->mouse",
+	"handler->pad post",
+	"pad post->emit",
+	"sensor->pad",
+};
+
+// Values below LATENCY_SUB_BUCKETS get a bucket each; above that, each power of two is split into
+// LATENCY_SUB_BUCKETS linear steps by the bits following the most significant one.
+static int BucketIndex(Uint32 value)
+{
+	if (value < LATENCY_SUB_BUCKETS) return (int)value;
+	int msb = SDL_MostSignificantBitIndex32(value);
+	return (msb - 2) * LATENCY_SUB_BUCKETS + (int)((value >> (msb - 3)) & (LATENCY_SUB_BUCKETS - 1));
+}
+
+static Uint64 BucketLowerBound(int index)
+{
+	if (index < LATENCY_SUB_BUCKETS) return (Uint64)index;
+	int msb = index / LATENCY_SUB_BUCKETS + 2;
+	return (Uint64)(LATENCY_SUB_BUCKETS + index % LATENCY_SUB_BUCKETS) << (msb - 3);
+}
+
+static Uint64 BucketUpperBound(int index)
+{
+	return BucketLowerBound(index + 1) - 1;
+}
+
+void Latency_Record(LatencyStage stage, Uint64 latency_ns)
+{
+	Uint32 value = (latency_ns > SDL_MAX_UINT32) ? SDL_MAX_UINT32 : (Uint32)latency_ns;
+	SDL_AddAtomicInt(&latency_histograms[stage].buckets[BucketIndex(value)], 1);
+}
+
+static Uint64 CopyBuckets(LatencyStage stage, Uint32 counts[LATENCY_BUCKET_COUNT])
+{
+	Uint64 total = 0;
+	for (int i = 0; i < LATENCY_BUCKET_COUNT; ++i) {
+		counts[i] = (Uint32)SDL_GetAtomicInt(&latency_histograms[stage].buckets[i]);
+		total += counts[i];
+	}
+	return total;
+}
+
+void Latency_GetSummary(LatencyStage stage, LatencySummary* summary)
+{
+	Uint32 counts[LATENCY_BUCKET_COUNT];
+	SDL_zerop(summary);
+	summary->count = CopyBuckets(stage, counts);
+	if (summary->count == 0) return;
+
+	// Rank of each percentile, rounded up so p99.9 of a small sample is its maximum.
+	const Uint64 rank50 = (summary->count * 500 + 999) / 1000;
+	const Uint64 rank99 = (summary->count * 990 + 999) / 1000;
+	const Uint64 rank999 = (summary->count * 999 + 999) / 1000;
+	Uint64 seen = 0;
+	for (int i = 0; i < LATENCY_BUCKET_COUNT; ++i) {
+		if (counts[i] == 0) continue;
+		Uint64 before = seen;
+		seen += counts[i];
+		if (before < rank50 && seen >= rank50) summary->p50_ns = BucketUpperBound(i);
+		if (before < rank99 && seen >= rank99) summary->p99_ns = BucketUpperBound(i);
+		if (seen >= rank999) { summary->p999_ns = BucketUpperBound(i); break; }
+	}
+}
+
+const char* Latency_GetStageName(LatencyStage stage)
+{
+	return latency_stage_names[stage];
+}
+
+Uint64 Latency_GetTotalCount(void)
+{
+	Uint64 total = 0;
+	for (int stage = 0; stage < LATENCY_STAGE_COUNT; ++stage) {
+		for (int i = 0; i < LATENCY_BUCKET_COUNT; ++i) total += (Uint32)SDL_GetAtomicInt(&latency_histograms[stage].buckets[i]);
+	}
+	return total;
+}
+
+void Latency_LogSummary(void)
+{
+	for (int stage = 0; stage < LATENCY_STAGE_COUNT; ++stage) {
+		LatencySummary summary;
+		Latency_GetSummary((LatencyStage)stage, &summary);
+		if (summary.count == 0) continue;
+		SDL_Log("Latency %s: %llu samples, p50 %.1f us, p99 %.1f us, p99.9 %.1f us.", latency_stage_names[stage],
+			(unsigned long long)summary.count, summary.p50_ns / 1e3, summary.p99_ns / 1e3, summary.p999_ns / 1e3);
+	}
+}
+
+bool Latency_WriteCsv(const char* path)
+{
+	if (Latency_GetTotalCount() == 0) return false;
+
+	FILE* file = NULL;
+	if (fopen_s(&file, path, "w") != 0 || !file) {
+		SDL_Log("Error: Could not write latency histograms to %s.", path);
+		return false;
+	}
+	fprintf(file, "stage,bucket_lower_ns,bucket_upper_ns,count,cumulative_fraction\n");
+	for (int stage = 0; stage < LATENCY_STAGE_COUNT; ++stage) {
+		Uint32 counts[LATENCY_BUCKET_COUNT];
+		Uint64 total = CopyBuckets((LatencyStage)stage, counts);
+		Uint64 seen = 0;
+		for (int i = 0; i < LATENCY_BUCKET_COUNT; ++i) {
+			if (counts[i] == 0) continue;
+			seen += counts[i];
+			fprintf(file, "%s,%llu,%llu,%u,%.6f\n", latency_stage_names[stage], (unsigned long long)BucketLowerBound(i),
+				(unsigned long long)BucketUpperBound(i), counts[i], (double)seen / total);
+		}
+	}
+	fclose(file);
+	SDL_Log("Latency histograms written to %s.", path);
+	return true;
+}
\ No newline at end of file
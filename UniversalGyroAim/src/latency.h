@@ -0,0 +1,15 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include "state.h"
+
+// Per-stage latency of the gyro pipeline, from sensor event to mouse or virtual pad output.
+void Latency_Record(LatencyStage stage, Uint64 latency_ns);
+void Latency_GetSummary(LatencyStage stage, LatencySummary* summary);
+const char* Latency_GetStageName(LatencyStage stage);
+Uint64 Latency_GetTotalCount(void); // Across all stages, for change detection
+void Latency_LogSummary(void);
+// One row per non-empty bucket of every stage. Returns false if nothing was recorded or the file failed.
+bool Latency_WriteCsv(const char* path);
+
+#endif
\ No newline at end of file
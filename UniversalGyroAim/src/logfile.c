@@ -0,0 +1,38 @@
+#include "logfile.h"
+#include <stdio.h>
+
+static FILE* log_file = NULL;
+static SDL_LogOutputFunction default_log_output = NULL;
+static void* default_log_userdata = NULL;
+
+static void SDLCALL LogToFile(void* userdata, int category, SDL_LogPriority priority, const char* message)
+{
+	if (default_log_output) default_log_output(default_log_userdata, category, priority, message);
+	if (log_file) {
+		Uint64 ms = SDL_GetTicks();
+		fprintf(log_file, "[%llu.%03llu] %s\n", (unsigned long long)(ms / 1000), (unsigned long long)(ms % 1000), message);
+		fflush(log_file);
+	}
+}
+
+bool LogFile_Open(const char* path)
+{
+	if (log_file) return true;
+	if (fopen_s(&log_file, path, "a") != 0 || !log_file) {
+		log_file = NULL;
+		SDL_Log("Error: Could not open log file %s.", path);
+		return false;
+	}
+	SDL_GetLogOutputFunction(&default_log_output, &default_log_userdata);
+	SDL_SetLogOutputFunction(LogToFile, NULL);
+	SDL_Log("--- Logging to %s ---", path);
+	return true;
+}
+
+void LogFile_Close(void)
+{
+	if (!log_file) return;
+	SDL_SetLogOutputFunction(default_log_output, default_log_userdata);
+	fclose(log_file);
+	log_file = NULL;
+}
\ No newline at end of file
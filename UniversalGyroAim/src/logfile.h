@@ -0,0 +1,10 @@
+#ifndef LOGFILE_H
+#define LOGFILE_H
+
+#include "state.h"
+
+// Mirrors SDL_Log output to a file, in addition to the default console output.
+bool LogFile_Open(const char* path);
+void LogFile_Close(void);
+
+#endif
\ No newline at end of file
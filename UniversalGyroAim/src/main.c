@@ -5,34 +5,121 @@
 #include "app.h"
 #include "config.h"
 #include "hidhide.h"
-#include "vigem.h"
 #include "mouse.h"
 #include "input.h"
 #include "ui.h"
+#include "visualizer.h"
+#include "bench.h"
+#include "pacing.h"
+#include "options.h"
+#include "logfile.h"
+#include "latency.h"
+#include "trace.h"
+#include "shm.h"
+#include "capture.h"
+#include "replay.h"
+#include "simulate.h"
+#include <stdlib.h>
+
+static bool pipeline_started = false; // Set once a normal run has every thread up; benches, replays and failed starts stay false
 
 SDL_AppResult SDL_AppInit(void** appstate, int argc, char* argv[])
 {
+	if (!Options_Parse(argc, argv)) return SDL_APP_FAILURE;
+	TRACE_THREAD("Main");
+	if (app_options.read_telemetry) {
+		// Only needs the quit event for Ctrl+C.
+		if (!SDL_InitSubSystem(SDL_INIT_EVENTS)) return SDL_APP_FAILURE;
+		return Shm_RunReader() ? SDL_APP_SUCCESS : SDL_APP_FAILURE;
+	}
+	if (app_options.log_path[0]) LogFile_Open(app_options.log_path);
+
 	SDL_SetHint(SDL_HINT_JOYSTICK_ALLOW_BACKGROUND_EVENTS, "1");
+	SDL_SetHint(SDL_HINT_AUTO_UPDATE_JOYSTICKS, "0"); // The input thread updates joysticks itself
 	if (SDL_InitSubSystem(SDL_INIT_GAMEPAD) < 0) return SDL_APP_FAILURE;
-	if (!SDL_CreateWindowAndRenderer("Universal Gyro Aim", 420, 195, 0, &window, &renderer)) return SDL_APP_FAILURE;
+	SDL_SetEventEnabled(SDL_EVENT_GAMEPAD_UPDATE_COMPLETE, true); // Disabled by default
+
+	if (app_options.bench_input) {
+		return Bench_RunInputMapping() ? SDL_APP_SUCCESS : SDL_APP_FAILURE;
+	}
+	if (app_options.bench_render) {
+		return Bench_RunRender() ? SDL_APP_SUCCESS : SDL_APP_FAILURE;
+	}
+	if (app_options.bench_path[0]) {
+		return Bench_RunSuite(app_options.bench_path) ? SDL_APP_SUCCESS : SDL_APP_FAILURE;
+	}
+	if (app_options.replay_path[0]) {
+		return Replay_Run(app_options.replay_path, app_options.replay_output_path, app_options.replay_golden_path, app_options.replay_mode) ? SDL_APP_SUCCESS : SDL_APP_FAILURE;
+	}
+	if (app_options.golden_suite_path[0]) {
+		return Replay_RunGoldenSuite(app_options.golden_suite_path, app_options.golden_suite_record) ? SDL_APP_SUCCESS : SDL_APP_FAILURE;
+	}
+	if (app_options.self_check) {
+		return Replay_RunSelfCheck() ? SDL_APP_SUCCESS : SDL_APP_FAILURE;
+	}
+
+	if (app_options.profile_name[0]) {
+		if (!LoadSettings(app_options.profile_name)) {
+			SDL_Log("Error: Could not load profile %s.", app_options.profile_name);
+			return SDL_APP_FAILURE;
+		}
+	}
+	else if (!LoadSettings(DEFAULT_PROFILE_FILENAME)) {
+		SetDefaultSettings();
+		SaveSettings(DEFAULT_PROFILE_FILENAME);
+	}
+
+	is_headless = app_options.headless || settings.headless || app_options.simulate;
+	if (is_headless) {
+		// No window or renderer; should anything still initialize video, it gets a driver that needs no display.
+		SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "dummy");
+		is_window_focused = false;
+		if (!app_options.log_path[0]) {
+			char log_path[MAX_PATH];
+			SDL_snprintf(log_path, sizeof(log_path), "%s%s", SDL_GetBasePath() ? SDL_GetBasePath() : "", HEADLESS_LOG_FILENAME);
+			LogFile_Open(log_path);
+		}
+		SDL_Log("Running headless with profile: %s", current_profile_name);
+	}
+	else if (!SDL_CreateWindowAndRenderer("Universal Gyro Aim", 420, 235, 0, &window, &renderer)) {
+		return SDL_APP_FAILURE;
+	}
 
 	if (!IsHidHideAvailable()) {
 		SDL_Log("Warning: HidHide driver/CLI not found. Controller hiding will not be available.");
 	}
 
-	if (!Vigem_Init()) {
+	if (app_options.simulate) {
+		if (!Simulate_InitOutputs()) return SDL_APP_FAILURE;
+	}
+	else if (!App_InitOutputs()) {
 		// UI will show error message, but we can continue to allow debugging.
 	}
 
-	if (!LoadSettings(DEFAULT_PROFILE_FILENAME)) {
-		SetDefaultSettings();
-		SaveSettings(DEFAULT_PROFILE_FILENAME);
+	Shm_Open(); // Optional; external readers just find no segment
+	if (app_options.capture_path[0] != '\0' && !Capture_Start(app_options.capture_path, false)) {
+		return SDL_APP_FAILURE;
 	}
 
 	if (!Mouse_StartThread()) {
 		return SDL_APP_FAILURE;
 	}
 
+	if (!HidHide_StartThread()) {
+		return SDL_APP_FAILURE;
+	}
+	// Pads present at startup were announced before the input thread existed; open them directly instead.
+	SDL_FlushEvents(SDL_EVENT_JOYSTICK_AXIS_MOTION, SDL_EVENT_GAMEPAD_STEAM_HANDLE_UPDATED);
+	App_FindAndOpenPhysicalGamepad();
+	if (!Input_StartThread()) {
+		return SDL_APP_FAILURE;
+	}
+	if (app_options.simulate && !Simulate_Start()) {
+		return SDL_APP_FAILURE;
+	}
+	Pacing_Init();
+	pipeline_started = true;
+
 	return SDL_APP_CONTINUE;
 }
 
@@ -40,44 +127,66 @@ SDL_AppResult SDL_AppEvent(void* appstate, SDL_Event* event)
 {
 	switch (event->type) {
 	case SDL_EVENT_QUIT: return SDL_APP_SUCCESS;
-	case SDL_EVENT_WINDOW_FOCUS_GAINED: is_window_focused = true; break;
+	case SDL_EVENT_WINDOW_FOCUS_GAINED: is_window_focused = true; UI_Invalidate(); break;
+	case SDL_EVENT_WINDOW_EXPOSED: UI_Invalidate(); break;
+	case SDL_EVENT_RENDER_TARGETS_RESET:
+	case SDL_EVENT_RENDER_DEVICE_RESET: Visualizer_Destroy(); UI_Invalidate(); break;
 	case SDL_EVENT_WINDOW_FOCUS_LOST: is_window_focused = false; break;
-	case SDL_EVENT_KEY_DOWN: UI_HandleKeyEvent(event); break;
+	case SDL_EVENT_KEY_DOWN: Input_LockState(); UI_HandleKeyEvent(event); Input_UnlockState(); break;
 	case SDL_EVENT_TEXT_INPUT: UI_HandleTextInputEvent(event); break;
-	case SDL_EVENT_GAMEPAD_ADDED: Input_HandleGamepadAdded(event); break;
-	case SDL_EVENT_GAMEPAD_REMOVED: Input_HandleGamepadRemoved(event); break;
-	case SDL_EVENT_GAMEPAD_BUTTON_DOWN:
-	case SDL_EVENT_GAMEPAD_BUTTON_UP: Input_HandleGamepadButton(event); break;
-	case SDL_EVENT_GAMEPAD_AXIS_MOTION: Input_HandleGamepadAxis(event); break;
-	case SDL_EVENT_GAMEPAD_SENSOR_UPDATE: Input_HandleGamepadSensor(event); break;
+	// Gamepad events are handled on the input thread; hotplug is also delivered here to trigger a redraw.
+	case SDL_EVENT_GAMEPAD_ADDED:
+	case SDL_EVENT_GAMEPAD_REMOVED: SDL_SetAtomicInt(&force_one_render, 1); break;
 	}
 	return SDL_APP_CONTINUE;
 }
 
 SDL_AppResult SDL_AppIterate(void* appstate)
 {
-	Input_UpdateCalibrationState();
-
-	XUSB_REPORT report = { 0 };
-	Input_ProcessAndPassthrough(&report);
+	if (Pacing_IsRenderDue()) UI_Render();
 
-	Vigem_Update(report);
-
-	UI_Render();
+	Pacing_Wait();
 
 	return SDL_APP_CONTINUE;
 }
 
 void SDL_AppQuit(void* appstate, SDL_AppResult result)
 {
+	if (app_options.read_telemetry) {
+		SDL_Quit(); // The reader started no pipeline and opened no files
+		return;
+	}
+	Pacing_LogStats();
+	if (app_options.simulate) Simulate_Stop();
+	Input_StopThread();
+	Shm_Close();
 	Mouse_StopThread();
-	UnhidePhysicalController();
-	Vigem_Shutdown();
+	Capture_Stop(); // After its producers, so the writer drains everything they queued
+	HidHide_StopThread();
+	App_ShutdownOutputs();
+
+	// Every pipeline thread has stopped, so the histograms are final.
+	bool simulation_passed = !app_options.simulate || Simulate_LogResults();
+	Latency_LogSummary();
+	if (pipeline_started) {
+		char csv_path[MAX_PATH];
+		SDL_snprintf(csv_path, sizeof(csv_path), "%s%s", SDL_GetBasePath() ? SDL_GetBasePath() : "", LATENCY_CSV_FILENAME);
+		Latency_WriteCsv(csv_path);
+	}
+#ifdef UGA_ENABLE_TRACE
+	char trace_path[MAX_PATH];
+	SDL_snprintf(trace_path, sizeof(trace_path), "%s%s", SDL_GetBasePath() ? SDL_GetBasePath() : "", TRACE_JSON_FILENAME);
+	Trace_Dump(trace_path, TRACE_DUMP_SECONDS);
+#endif
 
 	if (gamepad) {
 		SDL_CloseGamepad(gamepad);
 	}
-	SDL_DestroyRenderer(renderer);
-	SDL_DestroyWindow(window);
+	Visualizer_Destroy();
+	if (renderer) SDL_DestroyRenderer(renderer);
+	if (window) SDL_DestroyWindow(window);
+	Trace_Shutdown();
 	SDL_Quit();
+	LogFile_Close();
+	if (!simulation_passed) exit(EXIT_FAILURE); // The exit code is already decided by now, so fail the run directly
 }
\ No newline at end of file
@@ -1,81 +1,151 @@
 #include "mouse.h"
+#include "shared.h"
+#include "wakeup.h"
+#include "output.h"
+#include "telemetry.h"
+#include "latency.h"
+#include "trace.h"
+#include "clock.h"
+#include "config.h"
+#include "core/core.h"
+#ifdef _WIN32
 #pragma comment(lib, "winmm.lib")
+#endif
 
-DWORD WINAPI MouseThread(LPVOID lpParam) {
-	float accumulator_x = 0.0f;
-	float accumulator_y = 0.0f;
+// Fixed-rate polling needs 1 ms sleep granularity, which Windows only grants on request.
+static void SetTimerResolutionRaised(bool raised) {
+#ifdef _WIN32
+	if (raised) timeBeginPeriod(1);
+	else timeEndPeriod(1);
+#endif
+}
 
-	Uint64 perf_freq = SDL_GetPerformanceFrequency();
-	Uint64 last_time = SDL_GetPerformanceCounter();
+#ifdef _WIN32
+static void SendInput_MouseMove(const MouseMove* moves, int count) {
+	INPUT inputs[MOUSE_INPUT_BATCH_SIZE] = { 0 };
+	while (count > 0) {
+		int batch_count = (count < MOUSE_INPUT_BATCH_SIZE) ? count : MOUSE_INPUT_BATCH_SIZE;
+		for (int i = 0; i < batch_count; ++i) {
+			inputs[i].type = INPUT_MOUSE;
+			inputs[i].mi.dx = moves[i].dx;
+			inputs[i].mi.dy = moves[i].dy;
+			inputs[i].mi.dwFlags = MOUSEEVENTF_MOVE;
+		}
+		SendInput(batch_count, inputs, sizeof(INPUT));
+		moves += batch_count; count -= batch_count;
+	}
+}
 
-	timeBeginPeriod(1);
+const OutputSink sendinput_sink = { "SendInput", SendInput_MouseMove, NULL };
+#endif
 
-	while (run_mouse_thread) {
-		Uint64 current_time = SDL_GetPerformanceCounter();
-		float dt = (float)(current_time - last_time) / (float)perf_freq;
-		last_time = current_time;
-
-		EnterCriticalSection(&data_lock);
-		float current_gyro_x = shared_gyro_data[0];
-		float current_gyro_y = shared_gyro_data[1];
-		float flick_stick_dx = shared_flick_stick_delta_x;
-		shared_flick_stick_delta_x = 0.0f;
-		bool is_active = shared_mouse_aim_active;
-		LeaveCriticalSection(&data_lock);
-
-		float deltaX = flick_stick_dx;
-		float deltaY = 0.0f;
-
-		if (is_active) {
-			deltaX += current_gyro_y * dt * settings.mouse_sensitivity * (settings.invert_gyro_x ? 1.0f : -1.0f);
-			deltaY += current_gyro_x * dt * settings.mouse_sensitivity * (settings.invert_gyro_y ? 1.0f : -1.0f);
-		}
-		accumulator_x += deltaX;
-		accumulator_y += deltaY;
+// Emits one tick's movement: a single event by default, or evenly spaced sub-steps of at most mouse_max_step counts.
+static void EmitMouseMove(Sint32 move_x, Sint32 move_y) {
+	MouseMove moves[MOUSE_INPUT_BATCH_SIZE];
+	int batch_count = 0;
+
+	Sint32 steps = Core_MouseStepCount(move_x, move_y, settings.mouse_max_step);
+	for (Sint32 i = 0; i < steps; ++i) {
+		Core_MouseStep(move_x, move_y, steps, i, &moves[batch_count].dx, &moves[batch_count].dy);
+		batch_count++;
 
-		LONG move_x = 0, move_y = 0;
-		if (fabsf(accumulator_x) >= 1.0f) {
-			move_x = (LONG)accumulator_x; accumulator_x -= move_x;
+		if (batch_count == MOUSE_INPUT_BATCH_SIZE) {
+			Output_MouseMove(moves, batch_count); batch_count = 0;
 		}
-		if (fabsf(accumulator_y) >= 1.0f) {
-			move_y = (LONG)accumulator_y; accumulator_y -= move_y;
+	}
+	if (batch_count > 0) Output_MouseMove(moves, batch_count);
+	SDL_AddAtomicInt(&mouse_stats.events_injected, steps);
+}
+
+// Sub-count movement carried over to the next tick.
+static CoreSubCount accumulator = { 0 };
+
+// Integrates everything published since the last tick and emits the whole counts.
+void Mouse_Tick(void) {
+	static Uint64 event_timestamps[GYRO_QUEUE_CAPACITY]; // Per sample of the current tick, for the latency histograms
+	static Uint64 handoff_timestamps[GYRO_QUEUE_CAPACITY];
+
+	TRACE_BEGIN("MouseThread tick");
+	mouse_stats.wakeups++;
+
+	CoreConfig config;
+	BuildCoreConfig(&settings, &config);
+	float deltaX = Shared_TakeFlickStickDelta();
+	float deltaY = 0.0f;
+
+	GyroSample sample;
+	Uint64 oldest_timestamp = 0, timestamp_sum = 0;
+	int sample_count = 0;
+	// Bounded so the per-sample timestamps fit; anything left over was signalled and is taken on the next wakeup.
+	while (sample_count < GYRO_QUEUE_CAPACITY && Shared_PopGyroSample(&sample)) {
+		Core_IntegrateGyro(&config, sample.data, sample.dt, &deltaX, &deltaY);
+		if (sample_count == 0) oldest_timestamp = sample.timestamp_ns;
+		timestamp_sum += sample.timestamp_ns;
+		event_timestamps[sample_count] = sample.timestamp_ns;
+		handoff_timestamps[sample_count] = sample.handoff_ns;
+		sample_count++;
+	}
+	Sint32 move_x, move_y;
+	Core_SubCountAdd(&accumulator, deltaX, deltaY, &move_x, &move_y);
+
+	if (move_x != 0 || move_y != 0) {
+		EmitMouseMove(move_x, move_y);
+		Telemetry_AddMouseCounts(move_x, move_y);
+	}
+
+	if (sample_count > 0) {
+		Uint64 now = Clock_GetTicksNS();
+		mouse_stats.samples += sample_count;
+		mouse_stats.latency_sum_ns += now * sample_count - timestamp_sum;
+		Telemetry_SetLatency(now - timestamp_sum / sample_count);
+		for (int i = 0; i < sample_count; ++i) {
+			Latency_Record(LATENCY_MOUSE_EMIT, now - handoff_timestamps[i]);
+			Latency_Record(LATENCY_MOUSE_TOTAL, now - event_timestamps[i]);
 		}
+		if (now - oldest_timestamp > mouse_stats.latency_max_ns) mouse_stats.latency_max_ns = now - oldest_timestamp;
+	}
+	TRACE_END("MouseThread tick");
+}
+
+void Mouse_Reset(void) {
+	SDL_zero(accumulator);
+	SDL_zero(mouse_stats);
+	mouse_stats.start_ns = Clock_GetTicksNS();
+}
+
+static int SDLCALL MouseThread(void* data) {
+	bool timer_period_raised = false;
 
-		if (move_x != 0 || move_y != 0) {
-			INPUT inputs[MOUSE_INPUT_BATCH_SIZE] = { 0 };
-			int batch_count = 0;
-			long x_rem = move_x, y_rem = move_y;
-
-			while (x_rem != 0 || y_rem != 0) {
-				long dx = (labs(x_rem) > labs(y_rem)) ? ((x_rem > 0) ? 1 : -1) : 0;
-				long dy = (labs(y_rem) >= labs(x_rem)) ? ((y_rem > 0) ? 1 : -1) : 0;
-				x_rem -= dx; y_rem -= dy;
-
-				inputs[batch_count].type = INPUT_MOUSE;
-				inputs[batch_count].mi.dx = dx;
-				inputs[batch_count].mi.dy = dy;
-				inputs[batch_count].mi.dwFlags = MOUSEEVENTF_MOVE;
-				batch_count++;
-
-				if (batch_count == MOUSE_INPUT_BATCH_SIZE) {
-					SendInput(batch_count, inputs, sizeof(INPUT)); batch_count = 0;
-				}
-			}
-			if (batch_count > 0) SendInput(batch_count, inputs, sizeof(INPUT));
+	SDL_SetCurrentThreadPriority(SDL_THREAD_PRIORITY_TIME_CRITICAL);
+	TRACE_THREAD("MouseThread");
+	Mouse_Reset();
+
+	while (run_mouse_thread) {
+		// Fixed-rate fallback polls on a timer; otherwise block until a sample or flick delta is published.
+		if (settings.mouse_poll_rate > 0) {
+			if (!timer_period_raised) { SetTimerResolutionRaised(true); timer_period_raised = true; }
+			SDL_DelayNS(SDL_NS_PER_SECOND / settings.mouse_poll_rate);
 		}
-		Sleep(1);
+		else {
+			if (timer_period_raised) { SetTimerResolutionRaised(false); timer_period_raised = false; }
+			Wakeup_Wait(&mouse_wakeup, -1);
+		}
+		if (!run_mouse_thread) break;
+		Mouse_Tick();
 	}
 
-	timeEndPeriod(1);
+	if (timer_period_raised) SetTimerResolutionRaised(false);
 	return 0;
 }
 
 bool Mouse_StartThread(void) {
-	InitializeCriticalSection(&data_lock);
+	if (!Wakeup_Init(&mouse_wakeup)) {
+		SDL_Log("FATAL: Could not create mouse thread wakeup event!");
+		return false;
+	}
 	run_mouse_thread = true;
-	mouse_thread_handle = CreateThread(NULL, 0, MouseThread, NULL, 0, NULL);
-	if (mouse_thread_handle) {
-		SetThreadPriority(mouse_thread_handle, THREAD_PRIORITY_TIME_CRITICAL);
+	mouse_thread = SDL_CreateThread(MouseThread, "MouseThread", NULL);
+	if (mouse_thread) {
 		return true;
 	}
 	SDL_Log("FATAL: Could not create mouse thread!");
@@ -83,11 +153,17 @@ bool Mouse_StartThread(void) {
 }
 
 void Mouse_StopThread(void) {
-	if (mouse_thread_handle) {
+	if (mouse_thread) {
 		run_mouse_thread = false;
-		WaitForSingleObject(mouse_thread_handle, INFINITE);
-		CloseHandle(mouse_thread_handle);
-		mouse_thread_handle = NULL;
+		Wakeup_Signal(&mouse_wakeup);
+		SDL_WaitThread(mouse_thread, NULL);
+		mouse_thread = NULL;
+
+		double seconds = (double)(Clock_GetTicksNS() - mouse_stats.start_ns) / 1e9;
+		double avg_latency_ms = mouse_stats.samples ? (double)mouse_stats.latency_sum_ns / mouse_stats.samples / 1e6 : 0.0;
+		SDL_Log("Mouse thread stopped. %.1f wakeups/s, %.1f injected events/s, sample-to-emit latency avg %.3f ms / max %.3f ms, %d samples dropped on queue overflow.",
+			seconds > 0.0 ? mouse_stats.wakeups / seconds : 0.0, seconds > 0.0 ? (Uint32)SDL_GetAtomicInt(&mouse_stats.events_injected) / seconds : 0.0,
+			avg_latency_ms, mouse_stats.latency_max_ns / 1e6, SDL_GetAtomicInt(&gyro_samples_dropped));
 	}
-	DeleteCriticalSection(&data_lock);
+	Wakeup_Destroy(&mouse_wakeup);
 }
\ No newline at end of file
@@ -6,4 +6,8 @@
 bool Mouse_StartThread(void);
 void Mouse_StopThread(void);
 
+// One pass of the mouse thread, for callers that drive the pipeline themselves (replay).
+void Mouse_Tick(void);
+void Mouse_Reset(void); // Clears the carried sub-count movement and the stats
+
 #endif
\ No newline at end of file
@@ -0,0 +1,105 @@
+#include "options.h"
+
+static void PrintUsage(void)
+{
+	SDL_Log("Usage: UniversalGyroAim [--headless] [--profile <name>] [--log <file>] [--bench-input] [--bench-render] [--bench <file|->] [--read-telemetry] [--capture <file>] [--replay <file> [--replay-out <file>] [--replay-mode profile|mouse|joystick|flick] [--golden <file>]] [--golden-suite <dir> [--golden-suite-record]] [--self-check] [--simulate [--simulate-rate <hz>] [--simulate-seconds <s>] [--simulate-hotplug <ms>]]");
+}
+
+// Options taking a value accept both "--name value" and "--name=value".
+static const char* GetOptionValue(int argc, char* argv[], int* index, const char* name)
+{
+	size_t name_length = SDL_strlen(name);
+	if (SDL_strncmp(argv[*index], name, name_length) != 0) return NULL;
+	if (argv[*index][name_length] == '=') return argv[*index] + name_length + 1;
+	if (argv[*index][name_length] != '\0' || *index + 1 >= argc) return NULL;
+	return argv[++*index];
+}
+
+static bool ParseReplayMode(const char* value, ReplayMode* mode)
+{
+	static const char* names[REPLAY_MODE_COUNT] = { "profile", "mouse", "joystick", "flick" };
+	for (int i = 0; i < REPLAY_MODE_COUNT; ++i) {
+		if (SDL_strcasecmp(value, names[i]) == 0) {
+			*mode = (ReplayMode)i;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool Options_Parse(int argc, char* argv[])
+{
+	SDL_zero(app_options);
+	app_options.simulate_rate_hz = SIMULATE_DEFAULT_RATE_HZ;
+	app_options.simulate_seconds = SIMULATE_DEFAULT_SECONDS;
+	for (int i = 1; i < argc; ++i) {
+		const char* value;
+		if (SDL_strcmp(argv[i], "--headless") == 0) {
+			app_options.headless = true;
+		}
+		else if (SDL_strcmp(argv[i], "--bench-input") == 0) {
+			app_options.bench_input = true;
+		}
+		else if (SDL_strcmp(argv[i], "--bench-render") == 0) {
+			app_options.bench_render = true;
+		}
+		else if (SDL_strcmp(argv[i], "--read-telemetry") == 0) {
+			app_options.read_telemetry = true;
+		}
+		else if (SDL_strcmp(argv[i], "--golden-suite-record") == 0) {
+			app_options.golden_suite_record = true;
+		}
+		else if (SDL_strcmp(argv[i], "--self-check") == 0) {
+			app_options.self_check = true;
+		}
+		else if (SDL_strcmp(argv[i], "--simulate") == 0) {
+			app_options.simulate = true;
+		}
+		else if ((value = GetOptionValue(argc, argv, &i, "--simulate-rate")) != NULL) {
+			app_options.simulate_rate_hz = CLAMP(SDL_atoi(value), 1, SIMULATE_MAX_RATE_HZ);
+		}
+		else if ((value = GetOptionValue(argc, argv, &i, "--simulate-seconds")) != NULL) {
+			app_options.simulate_seconds = SDL_max(SDL_atoi(value), 1);
+		}
+		else if ((value = GetOptionValue(argc, argv, &i, "--simulate-hotplug")) != NULL) {
+			app_options.simulate_hotplug_ms = SDL_max(SDL_atoi(value), 0);
+		}
+		else if ((value = GetOptionValue(argc, argv, &i, "--profile")) != NULL) {
+			strcpy_s(app_options.profile_name, sizeof(app_options.profile_name), value);
+		}
+		else if ((value = GetOptionValue(argc, argv, &i, "--log")) != NULL) {
+			strcpy_s(app_options.log_path, sizeof(app_options.log_path), value);
+		}
+		else if ((value = GetOptionValue(argc, argv, &i, "--bench")) != NULL) {
+			strcpy_s(app_options.bench_path, sizeof(app_options.bench_path), value);
+		}
+		else if ((value = GetOptionValue(argc, argv, &i, "--capture")) != NULL) {
+			strcpy_s(app_options.capture_path, sizeof(app_options.capture_path), value);
+		}
+		else if ((value = GetOptionValue(argc, argv, &i, "--replay-out")) != NULL) {
+			strcpy_s(app_options.replay_output_path, sizeof(app_options.replay_output_path), value);
+		}
+		else if ((value = GetOptionValue(argc, argv, &i, "--replay-mode")) != NULL) {
+			if (!ParseReplayMode(value, &app_options.replay_mode)) {
+				SDL_Log("Error: Unknown replay mode %s.", value);
+				PrintUsage();
+				return false;
+			}
+		}
+		else if ((value = GetOptionValue(argc, argv, &i, "--golden-suite")) != NULL) {
+			strcpy_s(app_options.golden_suite_path, sizeof(app_options.golden_suite_path), value);
+		}
+		else if ((value = GetOptionValue(argc, argv, &i, "--golden")) != NULL) {
+			strcpy_s(app_options.replay_golden_path, sizeof(app_options.replay_golden_path), value);
+		}
+		else if ((value = GetOptionValue(argc, argv, &i, "--replay")) != NULL) {
+			strcpy_s(app_options.replay_path, sizeof(app_options.replay_path), value);
+		}
+		else if (SDL_strncmp(argv[i], "--", 2) == 0) {
+			SDL_Log("Error: Unknown or incomplete option %s.", argv[i]);
+			PrintUsage();
+			return false;
+		}
+	}
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,9 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include "state.h"
+
+// Fills app_options from the command line. Returns false on a malformed option.
+bool Options_Parse(int argc, char* argv[]);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,168 @@
+#include "output.h"
+#include "wakeup.h"
+#include "latency.h"
+#include "trace.h"
+#include "capture.h"
+#include "clock.h"
+
+#define PAD_MAILBOX_FRESH 4 // Set in the ready index while the slot holds a report the pad thread has not taken
+
+static void* active_mouse_sink = NULL;
+static void* active_pad_sink = NULL;
+
+// Last report handed to the pad sink, used to suppress identical resubmissions.
+static XUSB_REPORT last_pad_report;
+static Uint64 last_pad_submit_ns = 0;
+static bool has_last_pad_report = false;
+
+// Triple buffer: the producer and the pad thread each own one slot and swap it with the ready slot.
+static PadMailboxSlot pad_mailbox[3];
+static int pad_producer_slot = 0;
+static int pad_consumer_slot = 2;
+static SDL_AtomicInt pad_ready_slot = { 1 };
+
+void Output_SetMouseSink(const OutputSink* sink)
+{
+	SDL_SetAtomicPointer(&active_mouse_sink, (void*)sink);
+	SDL_Log("Mouse output: %s", sink ? sink->name : "none");
+}
+
+void Output_SetPadSink(const OutputSink* sink)
+{
+	SDL_SetAtomicPointer(&active_pad_sink, (void*)sink);
+	has_last_pad_report = false; // A new sink always receives the next report
+	SDL_Log("Virtual pad output: %s", sink ? sink->name : "none");
+}
+
+const OutputSink* Output_GetMouseSink(void)
+{
+	return (const OutputSink*)SDL_GetAtomicPointer(&active_mouse_sink);
+}
+
+const OutputSink* Output_GetPadSink(void)
+{
+	return (const OutputSink*)SDL_GetAtomicPointer(&active_pad_sink);
+}
+
+void Output_MouseMove(const MouseMove* moves, int count)
+{
+	const OutputSink* sink = Output_GetMouseSink();
+	if (sink && sink->mouse_move && count > 0) sink->mouse_move(moves, count);
+	Capture_MouseMoves(moves, count);
+}
+
+static void DeliverPadReport(const PadMailboxSlot* slot)
+{
+	const OutputSink* sink = Output_GetPadSink();
+	if (!sink || !sink->pad_update) return;
+
+	Uint64 call_start = Clock_GetTicksNS();
+	sink->pad_update(&slot->report);
+	Uint64 now = Clock_GetTicksNS();
+
+	SDL_AddAtomicInt(&pad_stats.delivered, 1);
+	pad_stats.latency_sum_ns += now - slot->queued_ns;
+	if (now - slot->queued_ns > pad_stats.latency_max_ns) pad_stats.latency_max_ns = now - slot->queued_ns;
+	if (now - call_start > pad_stats.call_max_ns) pad_stats.call_max_ns = now - call_start;
+	if (slot->gyro_event_ns) {
+		Latency_Record(LATENCY_PAD_EMIT, now - slot->queued_ns);
+		Latency_Record(LATENCY_PAD_TOTAL, now - slot->gyro_event_ns);
+	}
+}
+
+static int SDLCALL PadThread(void* data)
+{
+	TRACE_THREAD("PadThread");
+	while (run_pad_thread) {
+		Wakeup_Wait(&pad_wakeup, -1);
+		if (SDL_GetAtomicInt(&pad_ready_slot) & PAD_MAILBOX_FRESH) {
+			pad_consumer_slot = SDL_SetAtomicInt(&pad_ready_slot, pad_consumer_slot) & ~PAD_MAILBOX_FRESH;
+			DeliverPadReport(&pad_mailbox[pad_consumer_slot]);
+		}
+	}
+	return 0;
+}
+
+// Publishes the report to the pad thread without blocking; an unsent older report is overwritten.
+static void PostPadReport(const XUSB_REPORT* report, Uint64 gyro_event_ns)
+{
+	PadMailboxSlot* slot = &pad_mailbox[pad_producer_slot];
+	slot->report = *report;
+	slot->queued_ns = Clock_GetTicksNS();
+	slot->gyro_event_ns = gyro_event_ns;
+
+	if (!pad_thread) {
+		DeliverPadReport(slot);
+		return;
+	}
+	int previous = SDL_SetAtomicInt(&pad_ready_slot, pad_producer_slot | PAD_MAILBOX_FRESH);
+	if (previous & PAD_MAILBOX_FRESH) pad_stats.superseded++;
+	pad_producer_slot = previous & ~PAD_MAILBOX_FRESH;
+	Wakeup_Signal(&pad_wakeup);
+}
+
+// Submits the report only if it differs from the last one, or once the keep-alive period has elapsed.
+bool Output_PadUpdate(const XUSB_REPORT* report, Uint64 gyro_event_ns)
+{
+	const OutputSink* sink = Output_GetPadSink();
+	if (!sink || !sink->pad_update) return false;
+
+	Uint64 now = Clock_GetTicksNS();
+	if (has_last_pad_report && SDL_memcmp(report, &last_pad_report, sizeof(XUSB_REPORT)) == 0) {
+		if (settings.pad_keepalive_ms <= 0 || now - last_pad_submit_ns < SDL_MS_TO_NS((Uint64)settings.pad_keepalive_ms)) {
+			pad_stats.suppressed++;
+			return false;
+		}
+	}
+
+	PostPadReport(report, gyro_event_ns);
+	Capture_PadReport(report);
+	last_pad_report = *report;
+	last_pad_submit_ns = now;
+	has_last_pad_report = true;
+	pad_stats.submitted++;
+	return true;
+}
+
+bool Output_StartPadThread(void)
+{
+	if (!Wakeup_Init(&pad_wakeup)) {
+		SDL_Log("Warning: Could not create pad thread wakeup event, submitting pad reports inline.");
+		return false;
+	}
+	pad_producer_slot = 0;
+	pad_consumer_slot = 2;
+	SDL_SetAtomicInt(&pad_ready_slot, 1);
+	run_pad_thread = true;
+	pad_thread = SDL_CreateThread(PadThread, "PadThread", NULL);
+	if (pad_thread) {
+		return true;
+	}
+	SDL_Log("Warning: Could not create pad thread, submitting pad reports inline.");
+	Wakeup_Destroy(&pad_wakeup);
+	return false;
+}
+
+void Output_StopPadThread(void)
+{
+	if (pad_thread) {
+		run_pad_thread = false;
+		Wakeup_Signal(&pad_wakeup);
+		SDL_WaitThread(pad_thread, NULL);
+		pad_thread = NULL;
+		Wakeup_Destroy(&pad_wakeup);
+	}
+}
+
+void Output_LogPadStats(void)
+{
+	Uint64 total = pad_stats.submitted + pad_stats.suppressed;
+	Uint32 delivered = (Uint32)SDL_GetAtomicInt(&pad_stats.delivered);
+	SDL_Log("Virtual pad reports: %llu submitted, %llu suppressed (%.1f%%), %llu superseded in the mailbox.",
+		(unsigned long long)pad_stats.submitted, (unsigned long long)pad_stats.suppressed,
+		total ? 100.0 * pad_stats.suppressed / total : 0.0, (unsigned long long)pad_stats.superseded);
+	SDL_Log("Virtual pad delivery: %u reports, queue-to-submit latency avg %.3f ms / max %.3f ms, longest driver call %.3f ms.",
+		delivered, delivered ? (double)pad_stats.latency_sum_ns / delivered / 1e6 : 0.0,
+		pad_stats.latency_max_ns / 1e6, pad_stats.call_max_ns / 1e6);
+	SDL_zero(pad_stats);
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include "state.h"
+
+// --- Available sinks ---
+#ifdef _WIN32
+extern const OutputSink sendinput_sink;
+extern const OutputSink vigem_sink;
+#else
+extern const OutputSink uinput_sink;
+#endif
+extern const OutputSink record_sink;
+
+void Output_SetMouseSink(const OutputSink* sink);
+void Output_SetPadSink(const OutputSink* sink);
+const OutputSink* Output_GetMouseSink(void);
+const OutputSink* Output_GetPadSink(void);
+void Output_MouseMove(const MouseMove* moves, int count);
+// gyro_event_ns: event timestamp of the newest gyro sample the report reflects, for latency; 0 = none.
+// Returns false if the report was suppressed as unchanged.
+bool Output_PadUpdate(const XUSB_REPORT* report, Uint64 gyro_event_ns);
+bool Output_StartPadThread(void); // Without the thread, pad reports are submitted inline
+void Output_StopPadThread(void);
+void Output_LogPadStats(void);
+
+#endif
\ No newline at end of file
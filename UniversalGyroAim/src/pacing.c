@@ -0,0 +1,110 @@
+#include "pacing.h"
+#include "shared.h"
+#include "input.h"
+
+#ifndef _WIN32
+#include <time.h>
+#endif
+
+static Uint64 last_wait_ns = 0;
+static Uint64 last_cpu_ns = 0;
+static Uint64 next_render_ns = 0;
+
+static const char* pacing_state_names[PACING_STATE_COUNT] = { "idle", "active", "ui" };
+
+static Uint64 GetProcessCpuTimeNS(void)
+{
+#ifdef _WIN32
+	FILETIME creation_time, exit_time, kernel_time, user_time;
+	if (!GetProcessTimes(GetCurrentProcess(), &creation_time, &exit_time, &kernel_time, &user_time)) return 0;
+	ULARGE_INTEGER kernel, user;
+	kernel.LowPart = kernel_time.dwLowDateTime; kernel.HighPart = kernel_time.dwHighDateTime;
+	user.LowPart = user_time.dwLowDateTime; user.HighPart = user_time.dwHighDateTime;
+	return (kernel.QuadPart + user.QuadPart) * 100; // 100 ns units
+#else
+	struct timespec ts;
+	if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) != 0) return 0;
+	return (Uint64)ts.tv_sec * SDL_NS_PER_SECOND + (Uint64)ts.tv_nsec;
+#endif
+}
+
+static Uint64 GetRefreshIntervalNS(void)
+{
+	const SDL_DisplayMode* mode = window ? SDL_GetCurrentDisplayMode(SDL_GetDisplayForWindow(window)) : NULL;
+	float refresh_rate = (mode && mode->refresh_rate > 0.0f) ? mode->refresh_rate : PACING_DEFAULT_REFRESH_RATE;
+	return (Uint64)(1e9f / refresh_rate);
+}
+
+static bool NeedsRedraws(const InputSnapshot* input)
+{
+	if (!renderer) return false;
+	return is_window_focused || input->calibration_state != CALIBRATION_IDLE || SDL_GetAtomicInt(&force_one_render) != 0;
+}
+
+static PacingState ChoosePacingState(const InputSnapshot* input)
+{
+	bool gyro_is_active = input->has_gamepad && (input->is_aiming || input->settings.always_on_gyro || Shared_IsMouseAimActive() || input->calibration_state != CALIBRATION_IDLE);
+	if (gyro_is_active) return PACING_ACTIVE;
+	if (NeedsRedraws(input)) return PACING_UI;
+	return PACING_IDLE;
+}
+
+void Pacing_Init(void)
+{
+	SDL_zeroa(pacing_stats);
+	pacing_state = PACING_IDLE;
+	last_wait_ns = SDL_GetTicksNS();
+	last_cpu_ns = GetProcessCpuTimeNS();
+	next_render_ns = 0;
+}
+
+bool Pacing_IsRenderDue(void)
+{
+	InputSnapshot input;
+	Input_GetSnapshot(&input);
+	if (!NeedsRedraws(&input)) return false;
+	Uint64 now = SDL_GetTicksNS();
+	if (now < next_render_ns) return false;
+	Uint64 interval = GetRefreshIntervalNS();
+	next_render_ns = (now - next_render_ns < interval) ? next_render_ns + interval : now + interval; // Keep cadence, but never burst to catch up
+	return true;
+}
+
+void Pacing_Wait(void)
+{
+	// Attribute the iteration just finished, including the previous wait, to the state it ran in.
+	Uint64 now = SDL_GetTicksNS();
+	Uint64 cpu_now = GetProcessCpuTimeNS();
+	PacingStats* stats = &pacing_stats[pacing_state];
+	stats->iterations++;
+	stats->wall_ns += now - last_wait_ns;
+	stats->cpu_ns += cpu_now - last_cpu_ns;
+	last_wait_ns = now;
+	last_cpu_ns = cpu_now;
+
+	// Pad packets are handled on the input thread, so the active state only matters for accounting here.
+	InputSnapshot input;
+	Input_GetSnapshot(&input);
+	pacing_state = ChoosePacingState(&input);
+	Uint64 timeout_ns = SDL_MS_TO_NS(PACING_IDLE_TIMEOUT_MS);
+	if (NeedsRedraws(&input)) {
+		Uint64 until_render = (next_render_ns > now) ? next_render_ns - now : 0;
+		if (until_render < timeout_ns) timeout_ns = until_render;
+	}
+	if (timeout_ns == 0) return;
+
+	// Any event, such as a pad packet, ends the wait early; SDL dispatches it before the next iteration.
+	Sint32 timeout_ms = (Sint32)((timeout_ns + SDL_NS_PER_MS - 1) / SDL_NS_PER_MS);
+	SDL_WaitEventTimeout(NULL, timeout_ms);
+}
+
+void Pacing_LogStats(void)
+{
+	for (int i = 0; i < PACING_STATE_COUNT; ++i) {
+		const PacingStats* stats = &pacing_stats[i];
+		if (stats->wall_ns == 0) continue;
+		double seconds = (double)stats->wall_ns / 1e9;
+		SDL_Log("Main loop %s: %.1f s, %.1f iterations/s, %.1f ms CPU per second.",
+			pacing_state_names[i], seconds, stats->iterations / seconds, (double)stats->cpu_ns / 1e6 / seconds);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,12 @@
+#ifndef PACING_H
+#define PACING_H
+
+#include "state.h"
+
+// Paces SDL_AppIterate: blocks on events between UI redraws, which are capped at display refresh.
+void Pacing_Init(void);
+bool Pacing_IsRenderDue(void);
+void Pacing_Wait(void);
+void Pacing_LogStats(void);
+
+#endif
\ No newline at end of file
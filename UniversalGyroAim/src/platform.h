@@ -0,0 +1,37 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+// Maps the MSVC secure CRT calls used throughout the code onto portable equivalents on other platforms.
+#ifndef _WIN32
+#include <SDL3/SDL.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+
+#ifndef MAX_PATH
+#define MAX_PATH 4096
+#endif
+#define _countof(array) (sizeof(array) / sizeof((array)[0]))
+#define _stricmp strcasecmp
+#define _strdup strdup
+#define sscanf_s sscanf // Only for formats without %s, %c or %[ conversions, which take no size arguments here
+#define strcpy_s(dest, size, src) SDL_strlcpy((dest), (src), (size))
+#define strcat_s(dest, size, src) SDL_strlcat((dest), (src), (size))
+
+static inline int strncat_s(char* dest, size_t size, const char* src, size_t count)
+{
+	size_t len = strlen(dest);
+	for (size_t i = 0; i < count && src[i] && len + 1 < size; ++i) dest[len++] = src[i];
+	dest[len] = '\0';
+	return 0;
+}
+
+static inline int fopen_s(FILE** file, const char* path, const char* mode)
+{
+	*file = fopen(path, mode);
+	return *file ? 0 : errno;
+}
+#endif
+
+#endif
\ No newline at end of file
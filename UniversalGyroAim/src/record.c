@@ -0,0 +1,86 @@
+#include "record.h"
+#include "output.h"
+#include "clock.h"
+
+static RecordedMouseMove* recorded_mouse_moves = NULL;
+static RecordedPadReport* recorded_pad_reports = NULL;
+static int max_recorded_mouse_moves = 0;
+static int max_recorded_pad_reports = 0;
+static SDL_AtomicInt num_recorded_mouse_moves = { 0 };
+static SDL_AtomicInt num_recorded_pad_reports = { 0 };
+static SDL_AtomicInt num_overflowed_records = { 0 };
+
+bool Record_Start(int max_mouse_moves, int max_pad_reports)
+{
+	Record_Stop();
+	recorded_mouse_moves = (RecordedMouseMove*)SDL_calloc(max_mouse_moves > 0 ? max_mouse_moves : 1, sizeof(RecordedMouseMove));
+	recorded_pad_reports = (RecordedPadReport*)SDL_calloc(max_pad_reports > 0 ? max_pad_reports : 1, sizeof(RecordedPadReport));
+	if (!recorded_mouse_moves || !recorded_pad_reports) {
+		SDL_Log("Error: Could not allocate recording buffers.");
+		Record_Stop();
+		return false;
+	}
+	max_recorded_mouse_moves = max_mouse_moves;
+	max_recorded_pad_reports = max_pad_reports;
+	return true;
+}
+
+void Record_Stop(void)
+{
+	SDL_free(recorded_mouse_moves);
+	SDL_free(recorded_pad_reports);
+	recorded_mouse_moves = NULL;
+	recorded_pad_reports = NULL;
+	max_recorded_mouse_moves = 0;
+	max_recorded_pad_reports = 0;
+	SDL_SetAtomicInt(&num_recorded_mouse_moves, 0);
+	SDL_SetAtomicInt(&num_recorded_pad_reports, 0);
+	SDL_SetAtomicInt(&num_overflowed_records, 0);
+}
+
+const RecordedMouseMove* Record_GetMouseMoves(int* count)
+{
+	*count = SDL_GetAtomicInt(&num_recorded_mouse_moves);
+	return recorded_mouse_moves;
+}
+
+const RecordedPadReport* Record_GetPadReports(int* count)
+{
+	*count = SDL_GetAtomicInt(&num_recorded_pad_reports);
+	return recorded_pad_reports;
+}
+
+int Record_GetOverflowCount(void)
+{
+	return SDL_GetAtomicInt(&num_overflowed_records);
+}
+
+static void Record_MouseMove(const MouseMove* moves, int count)
+{
+	Uint64 now = Clock_GetTicksNS();
+	int index = SDL_GetAtomicInt(&num_recorded_mouse_moves);
+	for (int i = 0; i < count; ++i) {
+		if (index >= max_recorded_mouse_moves) {
+			SDL_AddAtomicInt(&num_overflowed_records, count - i);
+			break;
+		}
+		recorded_mouse_moves[index].time_ns = now;
+		recorded_mouse_moves[index].move = moves[i];
+		index++;
+	}
+	SDL_SetAtomicInt(&num_recorded_mouse_moves, index); // Publishes the new records to readers
+}
+
+static void Record_PadUpdate(const XUSB_REPORT* report)
+{
+	int index = SDL_GetAtomicInt(&num_recorded_pad_reports);
+	if (index >= max_recorded_pad_reports) {
+		SDL_AddAtomicInt(&num_overflowed_records, 1);
+		return;
+	}
+	recorded_pad_reports[index].time_ns = Clock_GetTicksNS();
+	recorded_pad_reports[index].report = *report;
+	SDL_SetAtomicInt(&num_recorded_pad_reports, index + 1);
+}
+
+const OutputSink record_sink = { "Record", Record_MouseMove, Record_PadUpdate };
\ No newline at end of file
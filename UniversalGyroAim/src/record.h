@@ -0,0 +1,24 @@
+#ifndef RECORD_H
+#define RECORD_H
+
+#include "state.h"
+
+typedef struct {
+	Uint64 time_ns;
+	MouseMove move;
+} RecordedMouseMove;
+
+typedef struct {
+	Uint64 time_ns;
+	XUSB_REPORT report;
+} RecordedPadReport;
+
+// In-memory recording sink. Each stream has a single writer (mouse thread / pad submitter), so no locks are taken.
+// Start and stop only while record_sink is not installed as an output.
+bool Record_Start(int max_mouse_moves, int max_pad_reports);
+void Record_Stop(void);
+const RecordedMouseMove* Record_GetMouseMoves(int* count);
+const RecordedPadReport* Record_GetPadReports(int* count);
+int Record_GetOverflowCount(void);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,543 @@
+#include "replay.h"
+#include "capture.h"
+#include "clock.h"
+#include "config.h"
+#include "input.h"
+#include "mouse.h"
+#include "output.h"
+#include "record.h"
+#include "shared.h"
+#include "wakeup.h"
+#include <math.h>
+
+// --- Output sink counting what the pipeline emitted ---
+static Sint64 replay_mouse_counts[2];
+static Uint64 replay_mouse_events;
+static Uint64 replay_pad_reports;
+static bool replay_recording = false; // Also pass the output to record_sink, for the golden comparison
+
+static void Replay_MouseMove(const MouseMove* moves, int count)
+{
+	for (int i = 0; i < count; ++i) {
+		replay_mouse_counts[0] += moves[i].dx;
+		replay_mouse_counts[1] += moves[i].dy;
+	}
+	replay_mouse_events += count;
+	if (replay_recording) record_sink.mouse_move(moves, count);
+}
+
+static void Replay_PadUpdate(const XUSB_REPORT* report)
+{
+	replay_pad_reports++;
+	if (replay_recording) record_sink.pad_update(report);
+}
+
+static const OutputSink replay_sink = { "Replay", Replay_MouseMove, Replay_PadUpdate };
+
+// Virtual time at which the input thread polls and the fixed-rate mouse thread ticks next.
+static Uint64 next_input_poll_ns;
+static Uint64 next_mouse_tick_ns;
+
+// Runs the periodic work the live threads would have done before now_ns.
+static void AdvanceTo(Uint64 now_ns)
+{
+	Uint64 mouse_period_ns = (settings.mouse_poll_rate > 0) ? SDL_NS_PER_SECOND / settings.mouse_poll_rate : 0;
+	for (;;) {
+		Uint64 next = next_input_poll_ns;
+		if (mouse_period_ns && next_mouse_tick_ns < next) next = next_mouse_tick_ns;
+		if (next > now_ns) break;
+
+		Clock_SetVirtualTime(next);
+		if (mouse_period_ns && next == next_mouse_tick_ns) {
+			Mouse_Tick();
+			next_mouse_tick_ns += mouse_period_ns;
+		}
+		if (next == next_input_poll_ns) {
+			Input_UpdateCalibrationState();
+			Input_SubmitFrameReport();
+			next_input_poll_ns += SDL_MS_TO_NS(INPUT_POLL_INTERVAL_MS);
+		}
+	}
+	Clock_SetVirtualTime(now_ns);
+}
+
+// Hands one recorded input to the handler its live event would have reached.
+static void DispatchRecord(const CaptureRecord* record)
+{
+	SDL_Event event;
+	SDL_zero(event);
+	event.common.timestamp = record->timestamp_ns;
+
+	switch (record->type) {
+	case CAPTURE_SENSOR:
+		event.type = SDL_EVENT_GAMEPAD_SENSOR_UPDATE;
+		event.gsensor.which = gamepad_instance_id;
+		event.gsensor.sensor = SDL_SENSOR_GYRO;
+		SDL_memcpy(event.gsensor.data, record->sensor.data, sizeof(record->sensor.data));
+		event.gsensor.sensor_timestamp = record->sensor.sensor_timestamp_ns;
+		Input_HandleGamepadSensor(&event);
+		break;
+	case CAPTURE_BUTTON:
+		event.type = record->button.down ? SDL_EVENT_GAMEPAD_BUTTON_DOWN : SDL_EVENT_GAMEPAD_BUTTON_UP;
+		event.gbutton.which = gamepad_instance_id;
+		event.gbutton.button = record->button.button;
+		event.gbutton.down = record->button.down;
+		Input_HandleGamepadButton(&event);
+		break;
+	case CAPTURE_AXIS:
+		event.type = SDL_EVENT_GAMEPAD_AXIS_MOTION;
+		event.gaxis.which = gamepad_instance_id;
+		event.gaxis.axis = record->axis.axis;
+		event.gaxis.value = record->axis.value;
+		Input_HandleGamepadAxis(&event);
+		break;
+	case CAPTURE_PACKET:
+		event.type = SDL_EVENT_GAMEPAD_UPDATE_COMPLETE;
+		event.gdevice.which = gamepad_instance_id;
+		Input_HandleGamepadUpdateComplete(&event);
+		break;
+	default:
+		break;
+	}
+}
+
+// --- Golden comparison ---
+typedef struct {
+	int mouse_counts; // Drift allowed in the cumulative mouse position, per axis
+	int stick_units; // Difference allowed per stick axis of a pad report; buttons and triggers must match
+} ReplayTolerance;
+
+// Mouse output is compared as a running total, so a filter change that moves a fraction of a count across a
+// tick boundary is not a divergence. Sticks only carry gyro in joystick mode.
+static const ReplayTolerance replay_tolerances[REPLAY_MODE_COUNT] = {
+	{ 2, 64 }, // Profile
+	{ 2, 0 }, // Mouse
+	{ 0, 64 }, // Joystick
+	{ 2, 0 }, // Flick stick
+};
+static const char* replay_mode_names[REPLAY_MODE_COUNT] = { "profile", "mouse", "joystick", "flick" };
+
+static RecordedMouseMove* golden_mouse_moves = NULL;
+static int golden_mouse_count = 0;
+static RecordedPadReport* golden_pad_reports = NULL;
+static int golden_pad_count = 0;
+static Uint64 replay_start_ns = 0; // First replayed timestamp; context lines are relative to it
+
+static void ApplyReplayMode(ReplayMode mode)
+{
+	switch (mode) {
+	case REPLAY_MODE_MOUSE: settings.mouse_mode = true; settings.flick_stick_enabled = false; break;
+	case REPLAY_MODE_JOYSTICK: settings.mouse_mode = false; settings.flick_stick_enabled = false; break;
+	case REPLAY_MODE_FLICK: settings.mouse_mode = true; settings.flick_stick_enabled = true; break;
+	default: break;
+	}
+}
+
+static void FreeGolden(void)
+{
+	SDL_free(golden_mouse_moves);
+	SDL_free(golden_pad_reports);
+	golden_mouse_moves = NULL;
+	golden_pad_reports = NULL;
+	golden_mouse_count = 0;
+	golden_pad_count = 0;
+}
+
+// Keeps the mouse and pad output of a capture written by --replay-out.
+static bool LoadGolden(const char* path)
+{
+	if (!Capture_OpenReader(path, NULL, NULL, 0)) return false;
+
+	int mouse_capacity = 0, pad_capacity = 0;
+	bool ok = true;
+	CaptureRecord record;
+	while (ok && Capture_ReadNext(&record)) {
+		if (record.type == CAPTURE_MOUSE) {
+			if (golden_mouse_count == mouse_capacity) {
+				mouse_capacity = mouse_capacity ? mouse_capacity * 2 : 4096;
+				RecordedMouseMove* grown = (RecordedMouseMove*)SDL_realloc(golden_mouse_moves, mouse_capacity * sizeof(RecordedMouseMove));
+				if (!grown) { ok = false; break; }
+				golden_mouse_moves = grown;
+			}
+			golden_mouse_moves[golden_mouse_count].time_ns = record.timestamp_ns;
+			golden_mouse_moves[golden_mouse_count++].move = record.mouse;
+		}
+		else if (record.type == CAPTURE_PAD) {
+			if (golden_pad_count == pad_capacity) {
+				pad_capacity = pad_capacity ? pad_capacity * 2 : 4096;
+				RecordedPadReport* grown = (RecordedPadReport*)SDL_realloc(golden_pad_reports, pad_capacity * sizeof(RecordedPadReport));
+				if (!grown) { ok = false; break; }
+				golden_pad_reports = grown;
+			}
+			golden_pad_reports[golden_pad_count].time_ns = record.timestamp_ns;
+			golden_pad_reports[golden_pad_count++].report = record.pad;
+		}
+	}
+	Capture_CloseReader();
+
+	if (!ok) {
+		SDL_Log("Error: Out of memory loading golden output %s.", path);
+		FreeGolden();
+		return false;
+	}
+	SDL_Log("Golden output %s: %d mouse events, %d virtual pad reports.", path, golden_mouse_count, golden_pad_count);
+	return true;
+}
+
+// Golden streams went through the capture format, which keeps microseconds.
+static Uint64 CaptureTime(Uint64 time_ns)
+{
+	return time_ns / SDL_NS_PER_US * SDL_NS_PER_US;
+}
+
+static void LogMouseContext(const char* label, const RecordedMouseMove* moves, int count, int index)
+{
+	for (int k = SDL_max(index - 3, 0); k <= SDL_min(index + 2, count - 1); ++k) {
+		SDL_Log("  %c %s[%d] +%.3f ms (%d, %d)", k == index ? '>' : ' ', label, k,
+			(moves[k].time_ns - replay_start_ns) / 1e6, moves[k].move.dx, moves[k].move.dy);
+	}
+}
+
+static void LogPadContext(const char* label, const RecordedPadReport* reports, int count, int index)
+{
+	for (int k = SDL_max(index - 3, 0); k <= SDL_min(index + 2, count - 1); ++k) {
+		const XUSB_REPORT* report = &reports[k].report;
+		SDL_Log("  %c %s[%d] +%.3f ms buttons %04X triggers %u/%u left (%d, %d) right (%d, %d)", k == index ? '>' : ' ', label, k,
+			(reports[k].time_ns - replay_start_ns) / 1e6, report->wButtons, report->bLeftTrigger, report->bRightTrigger,
+			report->sThumbLX, report->sThumbLY, report->sThumbRX, report->sThumbRY);
+	}
+}
+
+// Compares running totals after each timestamp of the golden stream, and once more at the end.
+static bool CompareMouse(const RecordedMouseMove* actual, int actual_count, int tolerance)
+{
+	Sint64 golden_x = 0, golden_y = 0, actual_x = 0, actual_y = 0;
+	int j = 0;
+	for (int i = 0; i <= golden_mouse_count; ++i) {
+		bool at_end = (i == golden_mouse_count);
+		if (!at_end) {
+			golden_x += golden_mouse_moves[i].move.dx;
+			golden_y += golden_mouse_moves[i].move.dy;
+			if (i + 1 < golden_mouse_count && golden_mouse_moves[i + 1].time_ns == golden_mouse_moves[i].time_ns) continue;
+		}
+		while (j < actual_count && (at_end || CaptureTime(actual[j].time_ns) <= golden_mouse_moves[i].time_ns)) {
+			actual_x += actual[j].move.dx;
+			actual_y += actual[j].move.dy;
+			j++;
+		}
+		Sint64 drift_x = golden_x - actual_x, drift_y = golden_y - actual_y;
+		if (drift_x > tolerance || -drift_x > tolerance || drift_y > tolerance || -drift_y > tolerance) {
+			int golden_index = at_end ? golden_mouse_count - 1 : i;
+			SDL_Log("Mouse output diverges%s: golden total (%lld, %lld), replay total (%lld, %lld), tolerance %d counts.",
+				at_end ? " by the end of the session" : "", (long long)golden_x, (long long)golden_y, (long long)actual_x, (long long)actual_y, tolerance);
+			if (golden_index >= 0) LogMouseContext("golden", golden_mouse_moves, golden_mouse_count, golden_index);
+			if (j > 0) LogMouseContext("replay", actual, actual_count, j - 1);
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool PadReportsMatch(const XUSB_REPORT* a, const XUSB_REPORT* b, int tolerance)
+{
+	return a->wButtons == b->wButtons && a->bLeftTrigger == b->bLeftTrigger && a->bRightTrigger == b->bRightTrigger &&
+		SDL_abs(a->sThumbLX - b->sThumbLX) <= tolerance && SDL_abs(a->sThumbLY - b->sThumbLY) <= tolerance &&
+		SDL_abs(a->sThumbRX - b->sThumbRX) <= tolerance && SDL_abs(a->sThumbRY - b->sThumbRY) <= tolerance;
+}
+
+// Index of the first report in a that differs from the report b had most recently sent by then; -1 if none.
+static int FindPadDivergence(const RecordedPadReport* a, int a_count, const RecordedPadReport* b, int b_count, int tolerance)
+{
+	int j = -1;
+	for (int i = 0; i < a_count; ++i) {
+		while (j + 1 < b_count && CaptureTime(b[j + 1].time_ns) <= CaptureTime(a[i].time_ns)) j++;
+		if (j < 0 || !PadReportsMatch(&a[i].report, &b[j].report, tolerance)) return i;
+	}
+	return -1;
+}
+
+static bool ComparePad(const RecordedPadReport* actual, int actual_count, int tolerance)
+{
+	int golden_index = FindPadDivergence(golden_pad_reports, golden_pad_count, actual, actual_count, tolerance);
+	int actual_index = FindPadDivergence(actual, actual_count, golden_pad_reports, golden_pad_count, tolerance);
+	if (golden_index < 0 && actual_index < 0) return true;
+
+	// Report whichever stream diverged first, with both streams around that moment.
+	Uint64 golden_time = (golden_index >= 0) ? golden_pad_reports[golden_index].time_ns : SDL_MAX_UINT64;
+	Uint64 actual_time = (actual_index >= 0) ? CaptureTime(actual[actual_index].time_ns) : SDL_MAX_UINT64;
+	Uint64 time = SDL_min(golden_time, actual_time);
+	int g = 0, a = 0;
+	while (g + 1 < golden_pad_count && golden_pad_reports[g + 1].time_ns <= time) g++;
+	while (a + 1 < actual_count && CaptureTime(actual[a + 1].time_ns) <= time) a++;
+
+	SDL_Log("Virtual pad output diverges at +%.3f ms, stick tolerance %d.", (time - replay_start_ns) / 1e6, tolerance);
+	if (golden_pad_count > 0) LogPadContext("golden", golden_pad_reports, golden_pad_count, g);
+	if (actual_count > 0) LogPadContext("replay", actual, actual_count, a);
+	return false;
+}
+
+static bool CompareWithGolden(ReplayMode mode)
+{
+	const ReplayTolerance* tolerance = &replay_tolerances[mode];
+	int mouse_count, pad_count;
+	const RecordedMouseMove* moves = Record_GetMouseMoves(&mouse_count);
+	const RecordedPadReport* reports = Record_GetPadReports(&pad_count);
+
+	bool ok = true;
+	if (Record_GetOverflowCount() > 0) {
+		SDL_Log("Replay produced more output than the golden stream allows for (%d records not kept).", Record_GetOverflowCount());
+		ok = false;
+	}
+	if (!CompareMouse(moves, mouse_count, tolerance->mouse_counts)) ok = false;
+	if (!ComparePad(reports, pad_count, tolerance->stick_units)) ok = false;
+	SDL_Log("Golden comparison in %s mode: %s.", replay_mode_names[mode], ok ? "matches" : "DIVERGED");
+	return ok;
+}
+
+// Starts from a freshly connected, idle pad, as the capture did.
+static void ResetPipelineState(void)
+{
+	SDL_zero(pad_state);
+	isAiming = false;
+	calibration_state = CALIBRATION_IDLE;
+	SDL_zero(flick_stick);
+	last_gyro_sensor_timestamp = 0;
+	last_pad_packet_ns = 0;
+	gyro_data[0] = 0.0f; gyro_data[1] = 0.0f; gyro_data[2] = 0.0f;
+	GyroSample stale;
+	while (Shared_PopGyroSample(&stale)) {}
+	Shared_TakeFlickStickDelta();
+
+	replay_mouse_counts[0] = 0;
+	replay_mouse_counts[1] = 0;
+	replay_mouse_events = 0;
+	replay_pad_reports = 0;
+}
+
+// The handlers only accept events from the open pad, so a virtual one takes the physical pad's place.
+static bool OpenReplayPad(const char* name)
+{
+	SDL_VirtualJoystickDesc desc;
+	SDL_INIT_INTERFACE(&desc);
+	desc.type = SDL_JOYSTICK_TYPE_GAMEPAD;
+	desc.naxes = SDL_GAMEPAD_AXIS_COUNT;
+	desc.nbuttons = SDL_GAMEPAD_BUTTON_COUNT;
+	desc.name = name;
+	SDL_JoystickID id = SDL_AttachVirtualJoystick(&desc);
+	gamepad = id ? SDL_OpenGamepad(id) : NULL;
+	if (!gamepad || !Wakeup_Init(&mouse_wakeup)) {
+		SDL_Log("Error: Could not create replay gamepad: %s", SDL_GetError());
+		if (gamepad) SDL_CloseGamepad(gamepad);
+		gamepad = NULL;
+		if (id) SDL_DetachVirtualJoystick(id);
+		return false;
+	}
+	gamepad_instance_id = id;
+	ResetPipelineState();
+	Output_SetMouseSink(&replay_sink);
+	Output_SetPadSink(&replay_sink);
+	return true;
+}
+
+static void CloseReplayPad(void)
+{
+	Output_SetMouseSink(NULL);
+	Output_SetPadSink(NULL);
+	Clock_UseRealTime();
+	Wakeup_Destroy(&mouse_wakeup);
+	SDL_CloseGamepad(gamepad);
+	gamepad = NULL;
+	SDL_DetachVirtualJoystick(gamepad_instance_id);
+}
+
+static bool RunSession(const char* capture_path, const char* output_path, ReplayMode mode)
+{
+	AppSettings captured_settings;
+	char captured_profile[64];
+	if (!Capture_OpenReader(capture_path, &captured_settings, captured_profile, sizeof(captured_profile))) return false;
+
+	if (app_options.profile_name[0]) {
+		if (!LoadSettings(app_options.profile_name)) {
+			SDL_Log("Error: Could not load profile %s.", app_options.profile_name);
+			Capture_CloseReader();
+			return false;
+		}
+	}
+	else {
+		settings = captured_settings;
+		strcpy_s(current_profile_name, sizeof(current_profile_name), captured_profile);
+	}
+	ApplyReplayMode(mode);
+
+	if (!OpenReplayPad("Universal Gyro Aim Replay Pad")) {
+		Capture_CloseReader();
+		return false;
+	}
+	if (output_path && output_path[0] && !Capture_Start(output_path, true)) {
+		output_path = NULL;
+	}
+
+	CaptureRecord record;
+	Uint64 records = 0, sensor_records = 0, first_ns = 0, last_ns = 0;
+	Uint64 wall_start = SDL_GetTicksNS();
+	while (Capture_ReadNext(&record)) {
+		// Aim state and mouse and pad output were produced by the pipeline; replay regenerates them.
+		if (record.type == CAPTURE_AIM || record.type == CAPTURE_MOUSE || record.type == CAPTURE_PAD) continue;
+		if (records == 0) {
+			first_ns = record.timestamp_ns;
+			next_input_poll_ns = first_ns;
+			next_mouse_tick_ns = first_ns;
+			replay_start_ns = first_ns;
+			Clock_SetVirtualTime(first_ns);
+			Mouse_Reset();
+		}
+		AdvanceTo(record.timestamp_ns);
+		DispatchRecord(&record);
+		// The event-driven mouse thread wakes for every published sample and flick delta.
+		if (settings.mouse_poll_rate <= 0 && (record.type == CAPTURE_SENSOR || record.type == CAPTURE_PACKET)) Mouse_Tick();
+
+		records++;
+		if (record.type == CAPTURE_SENSOR) sensor_records++;
+		last_ns = record.timestamp_ns;
+	}
+	Uint64 wall_ns = SDL_GetTicksNS() - wall_start;
+
+	if (output_path) Capture_Stop();
+	CloseReplayPad();
+	Capture_CloseReader();
+
+	double wall_seconds = wall_ns / 1e9;
+	double session_seconds = (last_ns - first_ns) / 1e9;
+	SDL_Log("Replayed %llu records (%llu gyro samples, %.1f s of session) in %.3f s: %.0f samples/s, %.1fx real time.",
+		(unsigned long long)records, (unsigned long long)sensor_records, session_seconds, wall_seconds,
+		wall_seconds > 0.0 ? sensor_records / wall_seconds : 0.0, wall_seconds > 0.0 ? session_seconds / wall_seconds : 0.0);
+	SDL_Log("Output: %llu mouse events totalling (%lld, %lld) counts, %llu virtual pad reports.",
+		(unsigned long long)replay_mouse_events, (long long)replay_mouse_counts[0], (long long)replay_mouse_counts[1],
+		(unsigned long long)replay_pad_reports);
+	return records > 0;
+}
+
+bool Replay_Run(const char* capture_path, const char* output_path, const char* golden_path, ReplayMode mode)
+{
+	bool compare = golden_path && golden_path[0];
+	if (compare) {
+		if (!LoadGolden(golden_path)) return false;
+		// Headroom for output the golden stream does not have; running out is reported as a divergence.
+		if (!Record_Start(golden_mouse_count * 2 + 4096, golden_pad_count * 2 + 4096)) {
+			FreeGolden();
+			return false;
+		}
+		replay_recording = true;
+	}
+
+	bool ok = RunSession(capture_path, output_path, mode);
+	if (compare) {
+		replay_recording = false;
+		if (ok) ok = CompareWithGolden(mode);
+		Record_Stop();
+		FreeGolden();
+	}
+	return ok;
+}
+
+static int CompareFileNames(const void* a, const void* b)
+{
+	return SDL_strcmp(*(const char* const*)a, *(const char* const*)b);
+}
+
+bool Replay_RunGoldenSuite(const char* directory, bool record)
+{
+	int count = 0;
+	char** captures = SDL_GlobDirectory(directory, "*.cap", SDL_GLOB_CASEINSENSITIVE, &count);
+	if (!captures || count == 0) {
+		SDL_Log("Error: No captures found in golden suite %s.", directory);
+		SDL_free(captures);
+		return false;
+	}
+	SDL_qsort(captures, count, sizeof(char*), CompareFileNames);
+	// The goldens were recorded with each capture's own settings.
+	app_options.profile_name[0] = '\0';
+
+	int runs = 0, failures = 0;
+	for (int i = 0; i < count; ++i) {
+		char capture_path[MAX_PATH];
+		SDL_snprintf(capture_path, sizeof(capture_path), "%s/%s", directory, captures[i]);
+		int stem_length = (int)SDL_strlen(captures[i]) - 4;
+		for (int mode = REPLAY_MODE_MOUSE; mode < REPLAY_MODE_COUNT; ++mode) {
+			char golden_path[MAX_PATH];
+			SDL_snprintf(golden_path, sizeof(golden_path), "%s/%.*s.%s.golden", directory, stem_length, captures[i], replay_mode_names[mode]);
+			bool ok = record ? Replay_Run(capture_path, golden_path, NULL, (ReplayMode)mode)
+				: Replay_Run(capture_path, NULL, golden_path, (ReplayMode)mode);
+			SDL_Log("Golden suite: %s in %s mode %s.", captures[i], replay_mode_names[mode], ok ? (record ? "recorded" : "passed") : "FAILED");
+			runs++;
+			if (!ok) failures++;
+		}
+	}
+	SDL_free(captures);
+	SDL_Log("Golden suite: %d of %d runs %s.", runs - failures, runs, record ? "recorded" : "passed");
+	return failures == 0;
+}
+
+static bool RunSelfCheck(int mouse_poll_rate)
+{
+	SetDefaultSettings();
+	settings.mouse_mode = true;
+	settings.always_on_gyro = true;
+	settings.mouse_poll_rate = mouse_poll_rate;
+	gyro_sample_interval_ns = SELF_CHECK_SAMPLE_INTERVAL_NS; // As reported by the pad's sensor rate
+	if (!OpenReplayPad("Universal Gyro Aim Self-check Pad")) return false;
+
+	const Uint64 start_ns = SDL_NS_PER_SECOND;
+	next_input_poll_ns = start_ns;
+	next_mouse_tick_ns = start_ns;
+	replay_start_ns = start_ns;
+	Clock_SetVirtualTime(start_ns);
+	Mouse_Reset();
+
+	CaptureRecord record;
+	SDL_zero(record);
+	record.type = CAPTURE_SENSOR;
+	record.sensor.data[0] = SELF_CHECK_PITCH_RATE;
+	record.sensor.data[1] = SELF_CHECK_YAW_RATE;
+	const int samples = SELF_CHECK_SECONDS * (int)(SDL_NS_PER_SECOND / SELF_CHECK_SAMPLE_INTERVAL_NS);
+	Uint64 burst_sensor_ns[SELF_CHECK_SAMPLES_PER_BURST];
+	Uint64 first_sensor_ns = 0, last_sensor_ns = start_ns;
+	for (int i = 0; i < samples; i += SELF_CHECK_SAMPLES_PER_BURST) {
+		int burst = SDL_min(SELF_CHECK_SAMPLES_PER_BURST, samples - i);
+		for (int j = 0; j < burst; ++j) {
+			last_sensor_ns += SELF_CHECK_SAMPLE_INTERVAL_NS + (Sint64)((i + j) % 5 - 2) * SELF_CHECK_JITTER_NS;
+			burst_sensor_ns[j] = last_sensor_ns;
+		}
+		if (i == 0) first_sensor_ns = burst_sensor_ns[0];
+
+		record.timestamp_ns = last_sensor_ns + SELF_CHECK_DELIVERY_NS;
+		AdvanceTo(record.timestamp_ns);
+		for (int j = 0; j < burst; ++j) {
+			record.sensor.sensor_timestamp_ns = burst_sensor_ns[j];
+			DispatchRecord(&record);
+			if (settings.mouse_poll_rate <= 0) Mouse_Tick();
+		}
+	}
+	// Lets a fixed-rate mouse thread take the last burst.
+	AdvanceTo(last_sensor_ns + SELF_CHECK_DELIVERY_NS + SDL_NS_PER_SECOND / 10);
+	CloseReplayPad();
+
+	// The first sample covers the nominal interval, every later one the gap on the sensor clock.
+	double seconds = (SELF_CHECK_SAMPLE_INTERVAL_NS + (last_sensor_ns - first_sensor_ns)) / 1e9;
+	double expected_x = -SELF_CHECK_YAW_RATE * seconds * settings.mouse_sensitivity;
+	double expected_y = -SELF_CHECK_PITCH_RATE * seconds * settings.mouse_sensitivity;
+	bool ok = fabs((double)replay_mouse_counts[0] - expected_x) <= 1.0 && fabs((double)replay_mouse_counts[1] - expected_y) <= 1.0;
+	SDL_Log("Self-check with mouse rate %d Hz: (%lld, %lld) counts for an integrated (%.2f, %.2f): %s.", mouse_poll_rate,
+		(long long)replay_mouse_counts[0], (long long)replay_mouse_counts[1], expected_x, expected_y, ok ? "passed" : "FAILED");
+	return ok;
+}
+
+bool Replay_RunSelfCheck(void)
+{
+	static const int mouse_poll_rates[] = { 0, 1000, 125 }; // Event-driven, and ticks faster and slower than the bursts
+	bool ok = true;
+	for (int i = 0; i < (int)SDL_arraysize(mouse_poll_rates); ++i) {
+		if (!RunSelfCheck(mouse_poll_rates[i])) ok = false;
+	}
+	return ok;
+}
\ No newline at end of file
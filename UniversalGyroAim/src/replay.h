@@ -0,0 +1,19 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "state.h"
+
+// Feeds a capture file through the real input, mouse and virtual pad pipeline on a virtual clock, as fast
+// as the CPU allows, then logs the throughput. The capture's settings are used unless a profile is given.
+// If output_path is set, the replayed session, including the mouse and pad output it produced, is captured
+// there in the same format. Such a file can serve as golden_path for a later run: the new output is then
+// compared against it with the tolerances of the mode, and the first divergence is logged with context.
+bool Replay_Run(const char* capture_path, const char* output_path, const char* golden_path, ReplayMode mode);
+// Replays every .cap in directory in the mouse, joystick and flick modes against the <name>.<mode>.golden
+// next to it; false if any run fails or diverges. With record set, writes those goldens instead.
+bool Replay_RunGoldenSuite(const char* directory, bool record);
+// Feeds a constant-rate rotation with jittered, bursty sensor timestamps through the same pipeline, event-driven
+// and at fixed mouse rates. False unless every run's mouse total is within one count of the integrated angle.
+bool Replay_RunSelfCheck(void);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,62 @@
+#include "shared.h"
+#include "wakeup.h"
+#include <string.h>
+
+bool Shared_PushGyroSample(const GyroSample* sample)
+{
+	Uint32 head = SDL_GetAtomicU32(&gyro_queue.head);
+	Uint32 tail = SDL_GetAtomicU32(&gyro_queue.tail);
+	if (head - tail >= GYRO_QUEUE_CAPACITY) {
+		SDL_AddAtomicInt(&gyro_samples_dropped, 1);
+		return false;
+	}
+
+	gyro_queue.samples[head & (GYRO_QUEUE_CAPACITY - 1)] = *sample;
+	SDL_SetAtomicU32(&gyro_queue.head, head + 1); // Publishes the slot to the consumer
+	Wakeup_Signal(&mouse_wakeup);
+	return true;
+}
+
+bool Shared_PopGyroSample(GyroSample* sample)
+{
+	Uint32 tail = SDL_GetAtomicU32(&gyro_queue.tail);
+	Uint32 head = SDL_GetAtomicU32(&gyro_queue.head);
+	if (tail == head) return false;
+
+	*sample = gyro_queue.samples[tail & (GYRO_QUEUE_CAPACITY - 1)];
+	SDL_SetAtomicU32(&gyro_queue.tail, tail + 1); // Hands the slot back to the producer
+	return true;
+}
+
+void Shared_AddFlickStickDelta(float delta)
+{
+	if (delta == 0.0f) return;
+
+	Uint32 old_bits, new_bits;
+	float value;
+	do {
+		old_bits = SDL_GetAtomicU32(&shared_flick_stick_delta_x);
+		memcpy(&value, &old_bits, sizeof(value));
+		value += delta;
+		memcpy(&new_bits, &value, sizeof(new_bits));
+	} while (!SDL_CompareAndSwapAtomicU32(&shared_flick_stick_delta_x, old_bits, new_bits));
+	Wakeup_Signal(&mouse_wakeup);
+}
+
+float Shared_TakeFlickStickDelta(void)
+{
+	Uint32 bits = SDL_SetAtomicU32(&shared_flick_stick_delta_x, 0); // All-zero bits are 0.0f
+	float value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+void Shared_SetMouseAimActive(bool active)
+{
+	SDL_SetAtomicInt(&shared_mouse_aim_active, active ? 1 : 0);
+}
+
+bool Shared_IsMouseAimActive(void)
+{
+	return SDL_GetAtomicInt(&shared_mouse_aim_active) != 0;
+}
\ No newline at end of file
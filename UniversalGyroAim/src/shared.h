@@ -0,0 +1,14 @@
+#ifndef SHARED_H
+#define SHARED_H
+
+#include "state.h"
+
+// Lock-free handoff between the event thread (producer) and the mouse thread (consumer).
+bool Shared_PushGyroSample(const GyroSample* sample);
+bool Shared_PopGyroSample(GyroSample* sample);
+void Shared_AddFlickStickDelta(float delta);
+float Shared_TakeFlickStickDelta(void);
+void Shared_SetMouseAimActive(bool active);
+bool Shared_IsMouseAimActive(void);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,204 @@
+#include "shm.h"
+#include "telemetry.h"
+#include "latency.h"
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static SharedTelemetrySegment* segment = NULL;
+#ifdef _WIN32
+static HANDLE segment_mapping = NULL;
+#endif
+static Uint64 next_publish_ns = 0;
+static Uint64 rate_window_start_ns = 0;
+static Uint32 rate_window_start_samples = 0;
+static float sensor_rate_hz = 0.0f;
+
+// Maps the segment, creating it for the writer. Returns NULL if it does not exist (reader) or mapping failed.
+static SharedTelemetrySegment* MapSegment(bool create)
+{
+	const size_t size = sizeof(SharedTelemetrySegment);
+#ifdef _WIN32
+	const char* name = "Local\\" SHM_SEGMENT_NAME;
+	HANDLE mapping = create ? CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, (DWORD)size, name)
+		: OpenFileMappingA(FILE_MAP_READ, FALSE, name);
+	if (!mapping) return NULL;
+	void* view = MapViewOfFile(mapping, create ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, 0, 0, size);
+	if (!view) {
+		CloseHandle(mapping);
+		return NULL;
+	}
+	if (create) segment_mapping = mapping;
+	else CloseHandle(mapping); // The view keeps the mapping alive
+	return (SharedTelemetrySegment*)view;
+#else
+	const char* name = "/" SHM_SEGMENT_NAME;
+	int fd = create ? shm_open(name, O_CREAT | O_RDWR, 0644) : shm_open(name, O_RDONLY, 0);
+	if (fd < 0) return NULL;
+	if (create && ftruncate(fd, (off_t)size) != 0) {
+		close(fd);
+		return NULL;
+	}
+	void* view = mmap(NULL, size, create ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+	close(fd); // The mapping keeps the object alive
+	return (view == MAP_FAILED) ? NULL : (SharedTelemetrySegment*)view;
+#endif
+}
+
+static void UnmapSegment(SharedTelemetrySegment* view)
+{
+#ifdef _WIN32
+	UnmapViewOfFile(view);
+#else
+	munmap(view, sizeof(SharedTelemetrySegment));
+#endif
+}
+
+bool Shm_Open(void)
+{
+	if (segment) return true;
+	segment = MapSegment(true);
+	if (!segment) {
+		SDL_Log("Warning: Could not create shared telemetry segment %s; external readers will see nothing.", SHM_SEGMENT_NAME);
+		return false;
+	}
+	SDL_SetAtomicU32(&segment->sequence, 0);
+	SDL_zero(segment->data);
+	segment->size = sizeof(SharedTelemetrySegment);
+	segment->version = SHM_SEGMENT_VERSION;
+	SDL_MemoryBarrierRelease();
+	segment->magic = SHM_SEGMENT_MAGIC; // Written last so readers never accept a half-initialized header
+	next_publish_ns = 0;
+	rate_window_start_ns = SDL_GetTicksNS();
+	rate_window_start_samples = Telemetry_GetRevision();
+	SDL_Log("Shared telemetry published as %s (version %d, %d bytes).", SHM_SEGMENT_NAME, SHM_SEGMENT_VERSION, (int)sizeof(SharedTelemetrySegment));
+	return true;
+}
+
+void Shm_Publish(void)
+{
+	if (!segment) return;
+	Uint64 now = SDL_GetTicksNS();
+	if (now < next_publish_ns) return;
+	next_publish_ns = now + SDL_MS_TO_NS(SHM_PUBLISH_INTERVAL_MS);
+
+	// Every gyro sample appends one telemetry row, so the ring head doubles as the sample counter.
+	Uint32 samples = Telemetry_GetRevision();
+	if (now - rate_window_start_ns >= SDL_NS_PER_SECOND) {
+		sensor_rate_hz = (float)(samples - rate_window_start_samples) * 1e9f / (float)(now - rate_window_start_ns);
+		rate_window_start_ns = now;
+		rate_window_start_samples = samples;
+	}
+
+	SharedTelemetry data;
+	SDL_zero(data);
+	data.publish_ns = now;
+	data.sensor_rate_hz = gamepad ? sensor_rate_hz : 0.0f;
+	data.gyro[0] = gyro_data[0]; data.gyro[1] = gyro_data[1]; data.gyro[2] = gyro_data[2];
+	data.has_gamepad = gamepad != NULL;
+	data.is_aiming = isAiming;
+	data.mouse_mode = settings.mouse_mode;
+	data.flick_stick_enabled = settings.flick_stick_enabled;
+	data.gyro_samples = samples;
+	Telemetry_GetEmittedCounts(data.mouse_counts);
+	data.mouse_events_injected = (Uint32)SDL_GetAtomicInt(&mouse_stats.events_injected);
+	data.pad_reports_submitted = pad_stats.submitted;
+	data.pad_reports_suppressed = pad_stats.suppressed;
+	data.pad_reports_delivered = (Uint32)SDL_GetAtomicInt(&pad_stats.delivered);
+	for (int stage = 0; stage < LATENCY_STAGE_COUNT; ++stage) {
+		LatencySummary summary;
+		Latency_GetSummary((LatencyStage)stage, &summary);
+		data.latency_us[stage][0] = summary.p50_ns / 1e3f;
+		data.latency_us[stage][1] = summary.p99_ns / 1e3f;
+		data.latency_us[stage][2] = summary.p999_ns / 1e3f;
+	}
+
+	// Seqlock write: odd while the payload is inconsistent.
+	Uint32 sequence = SDL_GetAtomicU32(&segment->sequence);
+	SDL_SetAtomicU32(&segment->sequence, sequence + 1);
+	SDL_MemoryBarrierRelease();
+	segment->data = data;
+	SDL_MemoryBarrierRelease();
+	SDL_SetAtomicU32(&segment->sequence, sequence + 2);
+}
+
+void Shm_Close(void)
+{
+	if (!segment) return;
+	UnmapSegment(segment);
+	segment = NULL;
+#ifdef _WIN32
+	CloseHandle(segment_mapping);
+	segment_mapping = NULL;
+#else
+	shm_unlink("/" SHM_SEGMENT_NAME);
+#endif
+}
+
+// The reader's view is read-only, and SDL atomics may be implemented with locked read-modify-write instructions.
+static Uint32 LoadSequence(const SharedTelemetrySegment* view)
+{
+	Uint32 sequence = *(const volatile Uint32*)&view->sequence.value;
+	SDL_MemoryBarrierAcquire();
+	return sequence;
+}
+
+// Seqlock read: copy, then retry if the writer was active before or during the copy.
+static bool ReadSegment(const SharedTelemetrySegment* view, SharedTelemetry* data, Uint32* sequence)
+{
+	for (int attempt = 0; attempt < 100; ++attempt) {
+		Uint32 before = LoadSequence(view);
+		if (before & 1) continue;
+		*data = view->data;
+		SDL_MemoryBarrierAcquire();
+		if (LoadSequence(view) == before) {
+			*sequence = before;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool Shm_RunReader(void)
+{
+	SharedTelemetrySegment* view = MapSegment(false);
+	if (!view) {
+		SDL_Log("Error: Shared telemetry segment %s not found. Is Universal Gyro Aim running?", SHM_SEGMENT_NAME);
+		return false;
+	}
+	if (view->magic != SHM_SEGMENT_MAGIC || view->version != SHM_SEGMENT_VERSION || view->size != sizeof(SharedTelemetrySegment)) {
+		SDL_Log("Error: Shared telemetry segment has version %u, size %u; this reader expects version %d, size %d.",
+			view->version, view->size, SHM_SEGMENT_VERSION, (int)sizeof(SharedTelemetrySegment));
+		UnmapSegment(view);
+		return false;
+	}
+
+	SDL_Log("Reading %s, press Ctrl+C to stop.", SHM_SEGMENT_NAME);
+	bool running = true;
+	while (running) {
+		SDL_Event event;
+		while (SDL_PollEvent(&event)) {
+			if (event.type == SDL_EVENT_QUIT) running = false;
+		}
+
+		SharedTelemetry data;
+		Uint32 sequence;
+		if (!ReadSegment(view, &data, &sequence)) {
+			SDL_Log("Segment busy, retrying.");
+		}
+		else {
+			SDL_Log("#%u pad=%u aim=%u rate=%.0f Hz gyro=(%.3f %.3f %.3f) mouse=(%lld %lld) events=%llu pad=%llu/%llu/%llu sensor->mouse p99=%.0f us sensor->pad p99=%.0f us",
+				sequence / 2, data.has_gamepad, data.is_aiming, data.sensor_rate_hz, data.gyro[0], data.gyro[1], data.gyro[2],
+				(long long)data.mouse_counts[0], (long long)data.mouse_counts[1], (unsigned long long)data.mouse_events_injected,
+				(unsigned long long)data.pad_reports_submitted, (unsigned long long)data.pad_reports_suppressed, (unsigned long long)data.pad_reports_delivered,
+				data.latency_us[LATENCY_MOUSE_TOTAL][1], data.latency_us[LATENCY_PAD_TOTAL][1]);
+		}
+		SDL_Delay(500);
+	}
+	UnmapSegment(view);
+	return true;
+}
\ No newline at end of file
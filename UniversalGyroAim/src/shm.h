@@ -0,0 +1,15 @@
+#ifndef SHM_H
+#define SHM_H
+
+#include "state.h"
+
+// Live counters for external tools in a named shared-memory segment (SharedTelemetrySegment), updated under a
+// seqlock: readers retry on a torn copy and never block the writer.
+bool Shm_Open(void);
+// Rate-limited to SHM_PUBLISH_INTERVAL_MS. Input thread only, with the input state locked.
+void Shm_Publish(void);
+void Shm_Close(void);
+// --read-telemetry: prints the segment of a running instance until interrupted.
+bool Shm_RunReader(void);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,193 @@
+#include "simulate.h"
+#include "output.h"
+#include "record.h"
+#include "input.h"
+#include <math.h>
+
+static SDL_Thread* simulate_thread = NULL;
+static volatile bool run_simulate_thread = false;
+static SDL_JoystickID simulated_pad_id = 0;
+static SDL_Joystick* simulated_pad = NULL;
+static int aim_button = -1; // The profile's aim input, saved at start: removing the pad clears it from the settings
+static int aim_axis = -1;
+
+// Written by the feeder thread, read once it has stopped.
+static Uint64 samples_sent = 0;
+static Uint64 hotplugs = 0;
+static double sent_rotation[2] = { 0.0, 0.0 }; // Integrated pitch and yaw, radians
+
+// Attaching and detaching announce the pad at once, and InputEventFilter handles that on the calling thread, so
+// callers hold the input lock around both.
+static bool AttachPad(void)
+{
+	SDL_VirtualJoystickSensorDesc sensor = { SDL_SENSOR_GYRO, (float)app_options.simulate_rate_hz };
+	SDL_VirtualJoystickDesc desc;
+	SDL_INIT_INTERFACE(&desc);
+	desc.type = SDL_JOYSTICK_TYPE_GAMEPAD;
+	desc.naxes = SDL_GAMEPAD_AXIS_COUNT;
+	desc.nbuttons = SDL_GAMEPAD_BUTTON_COUNT;
+	desc.nsensors = 1;
+	desc.sensors = &sensor;
+	desc.name = "Universal Gyro Aim Simulated Pad";
+
+	simulated_pad_id = SDL_AttachVirtualJoystick(&desc);
+	simulated_pad = simulated_pad_id ? SDL_OpenJoystick(simulated_pad_id) : NULL;
+	if (!simulated_pad) {
+		SDL_Log("Error: Could not create the simulated gamepad: %s", SDL_GetError());
+		if (simulated_pad_id) SDL_DetachVirtualJoystick(simulated_pad_id);
+		simulated_pad_id = 0;
+		return false;
+	}
+
+	// Hold whatever the profile aims with.
+	settings.selected_button = aim_button;
+	settings.selected_axis = aim_axis;
+	if (aim_button >= 0) SDL_SetJoystickVirtualButton(simulated_pad, aim_button, true);
+	else if (aim_axis >= 0) SDL_SetJoystickVirtualAxis(simulated_pad, aim_axis, SDL_JOYSTICK_AXIS_MAX);
+	return true;
+}
+
+static void DetachPad(void)
+{
+	if (simulated_pad) SDL_CloseJoystick(simulated_pad);
+	if (simulated_pad_id) SDL_DetachVirtualJoystick(simulated_pad_id);
+	simulated_pad = NULL;
+	simulated_pad_id = 0;
+}
+
+// Sends a slow sweep on pitch and a sweep with a steady turn on yaw at the configured rate, reattaching the pad on
+// the hot-plug period. The turn keeps the expected mouse total well away from zero for the end-of-run check.
+static int SDLCALL SimulateThread(void* data)
+{
+	const Uint64 period_ns = SDL_NS_PER_SECOND / app_options.simulate_rate_hz;
+	const Uint64 hotplug_ns = SDL_MS_TO_NS((Uint64)app_options.simulate_hotplug_ms);
+	const Uint64 start_ns = SDL_GetTicksNS();
+	const Uint64 end_ns = start_ns + SDL_SECONDS_TO_NS((Uint64)app_options.simulate_seconds);
+	Uint64 next_sample_ns = start_ns;
+	Uint64 next_hotplug_ns = start_ns + hotplug_ns;
+
+	while (run_simulate_thread && next_sample_ns < end_ns) {
+		Uint64 now = SDL_GetTicksNS();
+		if (next_sample_ns > now) SDL_DelayPrecise(next_sample_ns - now);
+
+		if (hotplug_ns && next_sample_ns >= next_hotplug_ns) {
+			Input_LockState();
+			DetachPad();
+			bool attached = AttachPad();
+			Input_UnlockState();
+			if (!attached) break;
+			hotplugs++;
+			next_hotplug_ns += hotplug_ns;
+		}
+
+		double t = (double)(next_sample_ns - start_ns) / 1e9;
+		float gyro[3] = {
+			(float)(1.0 * sin(2.0 * SDL_PI_D * 0.3 * t)),
+			(float)(SIMULATE_TURN_RATE + 2.0 * sin(2.0 * SDL_PI_D * 0.5 * t)),
+			0.0f,
+		};
+		SDL_SendJoystickVirtualSensorData(simulated_pad, SDL_SENSOR_GYRO, next_sample_ns, gyro, 3);
+		sent_rotation[0] += gyro[0] / (double)app_options.simulate_rate_hz;
+		sent_rotation[1] += gyro[1] / (double)app_options.simulate_rate_hz;
+		samples_sent++;
+		next_sample_ns += period_ns;
+	}
+
+	SDL_Event quit;
+	SDL_zero(quit);
+	quit.type = SDL_EVENT_QUIT;
+	SDL_PushEvent(&quit);
+	return 0;
+}
+
+bool Simulate_InitOutputs(void)
+{
+	// Room for every sample producing its own mouse event and pad report.
+	int capacity = app_options.simulate_rate_hz * app_options.simulate_seconds + 4096;
+	if (!Record_Start(capacity, capacity)) return false;
+	Output_SetMouseSink(&record_sink);
+	Output_SetPadSink(&record_sink);
+	Output_StartPadThread();
+	return true;
+}
+
+bool Simulate_Start(void)
+{
+	Input_LockState();
+	if (settings.selected_button < 0 && settings.selected_axis < 0 && !settings.always_on_gyro) {
+		SDL_Log("Simulation: the profile has no aim input, so gyro is forced always on.");
+		settings.always_on_gyro = true;
+	}
+	aim_button = settings.selected_button;
+	aim_axis = settings.selected_axis;
+	bool attached = AttachPad();
+	Input_UnlockState();
+	if (!attached) return false;
+
+	samples_sent = 0;
+	hotplugs = 0;
+	sent_rotation[0] = sent_rotation[1] = 0.0;
+	run_simulate_thread = true;
+	simulate_thread = SDL_CreateThread(SimulateThread, "SimulateThread", NULL);
+	if (!simulate_thread) {
+		SDL_Log("Error: Could not start the simulation thread.");
+		Input_LockState();
+		DetachPad();
+		Input_UnlockState();
+		return false;
+	}
+	SDL_Log("Simulating a gyro pad at %d Hz for %d s%s.", app_options.simulate_rate_hz, app_options.simulate_seconds,
+		app_options.simulate_hotplug_ms ? ", with hot-plugging" : "");
+	return true;
+}
+
+void Simulate_Stop(void)
+{
+	if (simulate_thread) {
+		run_simulate_thread = false;
+		SDL_WaitThread(simulate_thread, NULL);
+		simulate_thread = NULL;
+	}
+	Input_LockState();
+	DetachPad();
+	Input_UnlockState();
+}
+
+bool Simulate_LogResults(void)
+{
+	int mouse_count, pad_count;
+	const RecordedMouseMove* moves = Record_GetMouseMoves(&mouse_count);
+	Record_GetPadReports(&pad_count);
+	int overflowed = Record_GetOverflowCount(); // Record_Stop clears it
+	Sint64 total_x = 0, total_y = 0;
+	for (int i = 0; i < mouse_count; ++i) {
+		total_x += moves[i].move.dx;
+		total_y += moves[i].move.dy;
+	}
+
+	// What the mouse should receive for the sent rotation once the profile's calibration offset is taken out.
+	double seconds_sent = (double)samples_sent / app_options.simulate_rate_hz;
+	double rotation_x = sent_rotation[1] - settings.gyro_calibration_offset[1] * seconds_sent;
+	double rotation_y = sent_rotation[0] - settings.gyro_calibration_offset[0] * seconds_sent;
+	double expected_x = rotation_x * settings.mouse_sensitivity * (settings.invert_gyro_x ? 1.0 : -1.0);
+	double expected_y = rotation_y * settings.mouse_sensitivity * (settings.invert_gyro_y ? 1.0 : -1.0);
+	SDL_Log("Simulation: %llu gyro samples sent, %llu hot-plugs.", (unsigned long long)samples_sent, (unsigned long long)hotplugs);
+	SDL_Log("Simulation output: %d mouse events totalling (%lld, %lld) counts, expected about (%.0f, %.0f) in mouse mode; %d virtual pad reports; %d records over capacity.",
+		mouse_count, (long long)total_x, (long long)total_y, expected_x, expected_y, pad_count, overflowed);
+	Record_Stop();
+
+	// Gyro drives the mouse in mouse and flick stick mode and the virtual stick otherwise. Samples still in flight at
+	// shutdown and those sent while a hot-plug reattaches are lost, which the slack covers.
+	bool passed = (overflowed == 0);
+	if (settings.mouse_mode || settings.flick_stick_enabled) {
+		double lost_counts = (SIMULATE_TURN_RATE + 2.0) * SIMULATE_SLACK_MS / 1000.0 * settings.mouse_sensitivity * (double)(hotplugs + 1);
+		double slack_x = fabs(expected_x) * SIMULATE_TOLERANCE + lost_counts + 1.0;
+		double slack_y = fabs(expected_y) * SIMULATE_TOLERANCE + lost_counts + 1.0;
+		passed = passed && fabs((double)total_x - expected_x) <= slack_x && fabs((double)total_y - expected_y) <= slack_y;
+	}
+	else {
+		passed = passed && pad_count > 0;
+	}
+	if (!passed) SDL_Log("Simulation FAILED: the output is outside the tolerance of the sent rotation.");
+	return passed;
+}
\ No newline at end of file
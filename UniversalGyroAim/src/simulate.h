@@ -0,0 +1,13 @@
+#ifndef SIMULATE_H
+#define SIMULATE_H
+
+#include "state.h"
+
+// Headless end-to-end run on an SDL virtual gamepad with a gyro, for sensor-rate sweeps, hot-plug storms and
+// latency measurements without hardware. The app itself runs unchanged; only the pad and the outputs differ.
+bool Simulate_InitOutputs(void); // In place of App_InitOutputs: output goes to the in-memory record_sink
+bool Simulate_Start(void); // Once the input thread runs: attaches the pad and starts feeding it
+void Simulate_Stop(void); // Before the input thread stops
+bool Simulate_LogResults(void); // Once every pipeline thread has stopped; false when the output does not match what was sent
+
+#endif
\ No newline at end of file
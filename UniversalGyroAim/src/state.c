@@ -1,42 +1,86 @@
 #include "state.h"
 
 // --- Global Application State ---
+AppOptions app_options = { 0 };
+bool is_headless = false;
 SDL_Window* window = NULL;
 SDL_Renderer* renderer = NULL;
 SDL_Gamepad* gamepad = NULL;
 SDL_JoystickID gamepad_instance_id = 0;
 bool is_window_focused = true;
-bool force_one_render = false;
+SDL_AtomicInt force_one_render = { 0 };
 bool isAiming = false;
 AppSettings settings;
 bool settings_are_dirty = false;
 char current_profile_name[64] = DEFAULT_PROFILE_FILENAME;
 bool controller_has_led = false;
 CalibrationState calibration_state = CALIBRATION_IDLE;
-int calibration_sample_count = 0;
-float gyro_accumulator[3] = { 0.0f, 0.0f, 0.0f };
+CoreCalibration gyro_calibration = { 0 };
 float flick_stick_turn_remaining = 0.0f;
 Uint64 stability_timer_start_time = 0;
-float flick_last_angle = 0.0f;
-bool is_flick_stick_active = false;
+CoreFlickStick flick_stick = { 0 };
 
 // --- Driver/Library State ---
+#ifdef _WIN32
 PVIGEM_CLIENT vigem_client = NULL;
 PVIGEM_TARGET x360_pad = NULL;
 bool vigem_found = false;
-bool is_controller_hidden = false;
 wchar_t hidden_device_instance_path[MAX_PATH] = { 0 };
+#else
+bool uinput_found = false;
+#endif
+SDL_AtomicInt is_controller_hidden = { 0 };
+PadOutputStats pad_stats = { 0 };
+
+// --- Physical Pad State ---
+PadState pad_state = { 0 };
+Uint64 last_pad_packet_ns = 0;
 
 // --- Gyro Data ---
 float gyro_data[3] = { 0.0f, 0.0f, 0.0f };
+Uint64 last_gyro_sensor_timestamp = 0;
+Uint64 gyro_sample_interval_ns = GYRO_DEFAULT_SAMPLE_INTERVAL_NS;
 
 // --- Mouse Thread State ---
 volatile bool run_mouse_thread = false;
-HANDLE mouse_thread_handle = NULL;
-CRITICAL_SECTION data_lock;
-volatile float shared_gyro_data[3] = { 0.0f, 0.0f, 0.0f };
-volatile float shared_flick_stick_delta_x = 0.0f;
-volatile bool shared_mouse_aim_active = false;
+SDL_Thread* mouse_thread = NULL;
+Wakeup mouse_wakeup = WAKEUP_NONE;
+MouseThreadStats mouse_stats = { 0 };
+GyroSampleQueue gyro_queue = { 0 };
+SDL_AtomicU32 shared_flick_stick_delta_x = { 0 };
+SDL_AtomicInt shared_mouse_aim_active = { 0 };
+SDL_AtomicInt gyro_samples_dropped = { 0 };
+
+// --- Input Thread State ---
+volatile bool run_input_thread = false;
+SDL_Thread* input_thread = NULL;
+SDL_Mutex* input_lock = NULL;
+Wakeup input_wakeup = WAKEUP_NONE;
+InputThreadStats input_stats = { 0 };
+
+// --- Pad Submission Thread State ---
+volatile bool run_pad_thread = false;
+SDL_Thread* pad_thread = NULL;
+Wakeup pad_wakeup = WAKEUP_NONE;
+
+// --- Capture Writer Thread State ---
+volatile bool run_capture_thread = false;
+SDL_Thread* capture_thread = NULL;
+Wakeup capture_wakeup = WAKEUP_NONE;
+CaptureRing* capture_rings[CAPTURE_PRODUCER_COUNT] = { NULL };
+SDL_AtomicInt capture_records_dropped = { 0 };
+
+// --- Telemetry State ---
+TelemetryRing telemetry_ring = { 0 };
+SDL_AtomicInt telemetry_mouse_counts[2] = { 0 };
+SDL_AtomicU32 telemetry_latency_us = { 0 };
+
+// --- Latency State ---
+LatencyHistogram latency_histograms[LATENCY_STAGE_COUNT] = { 0 };
+
+// --- Main Loop Pacing State ---
+PacingState pacing_state = PACING_IDLE;
+PacingStats pacing_stats[PACING_STATE_COUNT] = { 0 };
 
 // --- UI State ---
 bool is_entering_text = false;
@@ -51,4 +95,6 @@ int selected_menu_item = 0;
 bool is_waiting_for_aim_button = false;
 char active_menu_label[128] = { 0 };
 int visible_menu_map[32]; // Max menu items
-int num_visible_menu_items = 0;
\ No newline at end of file
+int num_visible_menu_items = 0;
+bool show_telemetry = false;
+bool is_viewing_latency = false;
\ No newline at end of file
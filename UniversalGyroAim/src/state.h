@@ -3,9 +3,15 @@
 
 #include <SDL3/SDL.h>
 
+#ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
 #include <ViGEmClient.h>
+#else
+#include "xusb.h"
+#endif
+#include "platform.h"
+#include "core/core.h"
 
 #include <stdbool.h>
 
@@ -17,13 +23,78 @@
 #define PROFILES_DIRECTORY "UGA_profiles"
 #define DEFAULT_PROFILE_FILENAME "default.ini"
 #define CURRENT_CONFIG_VERSION 1
+#define SETTINGS_TEXT_MAX 2048 // Room for every key = value line of a profile
+#define HEADLESS_LOG_FILENAME "UniversalGyroAim.log"
+#define LATENCY_CSV_FILENAME "UniversalGyroAim_latency.csv"
+#define TRACE_JSON_FILENAME "UniversalGyroAim_trace.json"
 
 // --- Calibration Settings ---
 #define CALIBRATION_SAMPLES 200
 #define GYRO_STABILITY_THRESHOLD 0.1f
 #define GYRO_STABILITY_DURATION_MS 3000
 
+// --- Gyro Integration ---
+#define GYRO_DEFAULT_SAMPLE_INTERVAL_NS 4000000 // Used until the sensor reports its own rate
+#define GYRO_MAX_SAMPLE_INTERVAL_NS 50000000 // Longer gaps are clamped so a stall is not integrated as motion
+
+// --- Integration Self-check ---
+#define SELF_CHECK_SECONDS 10
+#define SELF_CHECK_YAW_RATE 3.0f // rad/s, held for the whole check
+#define SELF_CHECK_PITCH_RATE -1.0f
+#define SELF_CHECK_SAMPLE_INTERVAL_NS 1000000 // Nominal sensor rate, 1 kHz
+#define SELF_CHECK_JITTER_NS 200000 // Sensor intervals step through +-2 of these around the nominal one
+#define SELF_CHECK_SAMPLES_PER_BURST 4 // Samples delivered by one packet, all at the same event time
+#define SELF_CHECK_DELIVERY_NS 2000000 // From the last sample of a burst to its delivery
+
+// --- Virtual Pad Output ---
+#define PAD_PACKET_TIMEOUT_MS 100 // Without an update-complete event for this long, reports are built per frame instead
+
+// --- Input Thread ---
+#define INPUT_POLL_INTERVAL_MS 1 // Joystick polling while the pad is sending; without one, only hotplug is polled at PACING_IDLE_TIMEOUT_MS
+#define INPUT_IDLE_AFTER_MS 500 // A pad that sent no events for this long is polled at INPUT_IDLE_POLL_INTERVAL_MS
+#define INPUT_IDLE_POLL_INTERVAL_MS 16
+
+// --- Main Loop Pacing ---
+#define PACING_IDLE_TIMEOUT_MS 100 // Upper bound on blocking so timers and the frame fallback keep running
+#define PACING_DEFAULT_REFRESH_RATE 60.0f
+
+// --- Telemetry ---
+#define TELEMETRY_CAPACITY 512 // Must be a power of two
+#define TELEMETRY_CHART_POINTS 200 // Newest samples plotted; must stay well below TELEMETRY_CAPACITY
+#define TELEMETRY_PANEL_HEIGHT 120 // Added to the window height while the chart is shown
+
+// --- Latency Histograms ---
+#define LATENCY_SUB_BUCKETS 8 // Buckets per power of two, so each spans at most 12.5% of its value
+#define LATENCY_BUCKET_COUNT (30 * LATENCY_SUB_BUCKETS) // Values are clamped to 32-bit nanoseconds (~4.3 s)
+
+// --- Tracing (UGA_ENABLE_TRACE builds only) ---
+#define TRACE_MAX_THREADS 8
+#define TRACE_BUFFER_RECORDS 65536 // Per thread; must be a power of two
+#define TRACE_DUMP_SECONDS 10
+
+// --- Shared-memory telemetry for external tools ---
+#define SHM_SEGMENT_NAME "UniversalGyroAim.Telemetry" // "Local\\" prefix on Windows, "/" prefix for shm_open
+#define SHM_SEGMENT_MAGIC 0x54414755 // "UGAT" in memory on little-endian
+#define SHM_SEGMENT_VERSION 1 // Bump on any layout change of SharedTelemetrySegment
+#define SHM_PUBLISH_INTERVAL_MS 10
+
+// --- Session Capture ---
+#define CAPTURE_FILE_VERSION 3
+#define CAPTURE_RING_CAPACITY 8192 // Records per producer thread; must be a power of two
+#define CAPTURE_CHUNK_BYTES 65536 // A chunk is written once its encoded payload reaches this size
+#define CAPTURE_FLUSH_INTERVAL_MS 50 // How often the writer thread drains the rings
+#define CAPTURE_GYRO_SCALE 10000.0f // Gyro rates are stored in 1e-4 rad/s steps
+
+// --- Simulated Pad ---
+#define SIMULATE_DEFAULT_RATE_HZ 1000
+#define SIMULATE_DEFAULT_SECONDS 10
+#define SIMULATE_MAX_RATE_HZ 8000
+#define SIMULATE_TURN_RATE 0.5 // Steady yaw, rad/s, under the sweep
+#define SIMULATE_TOLERANCE 0.02 // Allowed mouse total error, as a fraction of the expected total
+#define SIMULATE_SLACK_MS 5 // Rotation allowed lost at shutdown and on each hot-plug, in milliseconds of peak rate
+
 #define MOUSE_INPUT_BATCH_SIZE 64
+#define GYRO_QUEUE_CAPACITY 256 // Must be a power of two
 #define CLAMP(v, min, max) (((v) < (min)) ? (min) : (((v) > (max)) ? (max) : (v)))
 
 // --- Calibration State Machine ---
@@ -55,52 +126,382 @@ typedef struct {
 	bool flick_stick_enabled;
 	bool flick_stick_calibrated;
 	float flick_stick_calibration_value; // Mouse units for a 360 turn
+	int mouse_poll_rate; // Hz; 0 = wake the mouse thread only when new data arrives
+	int mouse_max_step; // Max counts per injected event; 0 = one event per tick with the full delta
+	int pad_keepalive_ms; // Resubmit an unchanged pad report after this long; 0 = only submit on change
+	bool headless; // Run without a window; only honored when loaded at startup
 } AppSettings;
 
+// --- Aim mode a replay forces, overriding the captured settings ---
+typedef enum {
+	REPLAY_MODE_PROFILE, // As captured, or as the --profile given
+	REPLAY_MODE_MOUSE,
+	REPLAY_MODE_JOYSTICK,
+	REPLAY_MODE_FLICK,
+	REPLAY_MODE_COUNT
+} ReplayMode;
+
+// --- Command line options ---
+typedef struct {
+	bool headless;
+	bool bench_input;
+	bool bench_render;
+	char bench_path[MAX_PATH]; // Stage benchmark JSON output, "-" = stdout; empty = no benchmark
+	bool read_telemetry;
+	char capture_path[MAX_PATH]; // Empty = no capture
+	char replay_path[MAX_PATH]; // Capture file to run through the pipeline instead of a live pad
+	char replay_output_path[MAX_PATH]; // Empty = replay without writing the resulting stream
+	char replay_golden_path[MAX_PATH]; // Replay output to compare against; empty = no comparison
+	ReplayMode replay_mode;
+	char golden_suite_path[MAX_PATH]; // Directory of captures and goldens to check; empty = no suite
+	bool golden_suite_record; // Rewrite the suite's goldens instead of checking them
+	bool self_check; // Check gyro integration against a synthetic constant-rate rotation, then exit
+	bool simulate; // Drive the app from a virtual gamepad with a gyro instead of a physical pad
+	int simulate_rate_hz;
+	int simulate_seconds; // Quit after this long
+	int simulate_hotplug_ms; // Detach and reattach the virtual pad this often; 0 = never
+	char profile_name[64]; // Empty = default profile
+	char log_path[MAX_PATH]; // Empty = log to the console only, unless headless
+} AppOptions;
+
+// --- Calibrated gyro sample handed from the event thread to the mouse thread ---
+typedef struct {
+	float data[3]; // [0]=Pitch, [1]=Yaw, [2]=Roll
+	float dt; // Seconds covered by this sample, from consecutive sensor timestamps
+	Uint64 timestamp_ns; // SDL event timestamp
+	Uint64 sensor_timestamp_ns;
+	Uint64 handoff_ns; // When the event thread queued the sample
+} GyroSample;
+
+// --- Single-producer/single-consumer ring buffer of gyro samples ---
+typedef struct {
+	SDL_AtomicU32 head; // Written by the producer only
+	char head_padding[64 - sizeof(SDL_AtomicU32)];
+	SDL_AtomicU32 tail; // Written by the consumer only
+	char tail_padding[64 - sizeof(SDL_AtomicU32)];
+	GyroSample samples[GYRO_QUEUE_CAPACITY];
+} GyroSampleQueue;
+
+// --- One telemetry row per gyro sample ---
+typedef struct {
+	float gyro_rate[3]; // Calibrated, rad/s
+	float mouse_counts[2]; // Mouse counts emitted since the previous row
+	float sample_interval_ms;
+	float latency_ms; // Latest sensor-to-emit latency: mouse move in mouse mode, pad report otherwise
+} TelemetrySample;
+
+// --- Overwriting ring of telemetry rows: the input thread writes, the UI copies the newest ---
+typedef struct {
+	SDL_AtomicU32 head; // Written by the input thread only
+	TelemetrySample samples[TELEMETRY_CAPACITY];
+} TelemetryRing;
+
+// --- Physical pad state, kept current from button and axis events; indexed by SDL_GamepadButton and SDL_GamepadAxis ---
+typedef CorePadState PadState;
+
+// --- Relative mouse movement delivered to an output sink ---
+typedef struct {
+	Sint32 dx;
+	Sint32 dy;
+} MouseMove;
+
+// --- Output sink: the backend that receives mouse moves and virtual pad reports ---
+typedef struct {
+	const char* name;
+	void (*mouse_move)(const MouseMove* moves, int count); // NULL if the sink has no mouse output
+	void (*pad_update)(const XUSB_REPORT* report); // NULL if the sink has no virtual pad
+} OutputSink;
+
+// --- Thread wakeup primitive (Win32 event / Linux eventfd) ---
+typedef struct {
+#ifdef _WIN32
+	HANDLE handle;
+#else
+	int fd;
+#endif
+} Wakeup;
+
+// Initializer for a wakeup that has not been created; signaling or destroying it does nothing.
+#ifdef _WIN32
+#define WAKEUP_NONE { NULL }
+#else
+#define WAKEUP_NONE { -1 }
+#endif
+
+// --- Mouse thread counters, written only by the mouse thread ---
+typedef struct {
+	Uint64 start_ns;
+	Uint64 wakeups;
+	Uint64 samples;
+	Uint64 latency_sum_ns; // Sample event timestamp to emission
+	Uint64 latency_max_ns;
+	SDL_AtomicInt events_injected; // Also read by Shm_Publish on the input thread; 32 bits, so readers take differences
+} MouseThreadStats;
+
+// --- Virtual pad report counters, written only by the main thread ---
+typedef struct {
+	Uint64 submitted;
+	Uint64 suppressed; // Identical to the last submitted report and within the keep-alive period
+	Uint64 superseded; // Replaced in the mailbox by a newer report before the pad thread picked it up
+	// Written only by the pad thread
+	SDL_AtomicInt delivered; // Also read by Shm_Publish on the input thread; 32 bits, so readers take differences
+	Uint64 latency_sum_ns; // Report queued to sink call returned
+	Uint64 latency_max_ns;
+	Uint64 call_max_ns; // Longest single sink call, i.e. the worst driver stall
+} PadOutputStats;
+
+// --- Single-slot "latest report wins" mailbox between the main thread and the pad thread ---
+typedef struct {
+	XUSB_REPORT report;
+	Uint64 queued_ns;
+	Uint64 gyro_event_ns; // Event timestamp of the newest gyro sample in the report; 0 = none
+} PadMailboxSlot;
+
+// --- Input thread counters, written only by the input thread ---
+typedef struct {
+	Uint64 start_ns;
+	Uint64 polls;
+	Uint64 reports; // Latency samples: reports built after a new gyro sample
+	Uint64 latency_sum_ns; // Gyro event timestamp to report handed to the output layer
+	Uint64 latency_max_ns;
+} InputThreadStats;
+
+// --- Input state published by the input thread; the UI renders from a copy ---
+typedef struct {
+	Uint32 revision; // Bumped whenever anything besides the live gyro and aim state changes
+	AppSettings settings;
+	char profile_name[64];
+	bool settings_are_dirty;
+	bool has_gamepad;
+	bool controller_has_led;
+	bool is_controller_hidden;
+	bool is_aiming;
+	bool is_waiting_for_aim_button;
+	CalibrationState calibration_state;
+	int calibration_sample_count;
+	Uint64 stability_timer_start_time;
+	float gyro_data[3];
+} InputSnapshot;
+
+// --- Gyro pipeline stages timed by the latency histograms ---
+typedef enum {
+	LATENCY_DISPATCH, // Sensor event timestamp to handler entry
+	LATENCY_MOUSE_HANDOFF, // Handler entry to the sample queued for the mouse thread
+	LATENCY_MOUSE_EMIT, // Queued to mouse output returned
+	LATENCY_MOUSE_TOTAL, // Sensor event to mouse output returned
+	LATENCY_PAD_HANDOFF, // Handler entry to the report posted to the pad thread
+	LATENCY_PAD_EMIT, // Posted to virtual pad update returned
+	LATENCY_PAD_TOTAL, // Sensor event to virtual pad update returned
+	LATENCY_STAGE_COUNT
+} LatencyStage;
+
+// --- Log-bucketed histogram; any thread may record, readers see a consistent-enough copy without locking ---
+typedef struct {
+	SDL_AtomicInt buckets[LATENCY_BUCKET_COUNT];
+} LatencyHistogram;
+
+typedef struct {
+	Uint64 count;
+	Uint64 p50_ns; // Percentiles are bucket upper bounds
+	Uint64 p99_ns;
+	Uint64 p999_ns;
+} LatencySummary;
+
+// --- Trace record: begin or end of a named span on one thread ---
+typedef struct {
+	Uint64 timestamp_ns;
+	const char* name; // String literal
+	char phase; // 'B' or 'E', as in the Chrome trace format
+} TraceRecord;
+
+// --- Per-thread overwriting ring of trace records; only the owning thread writes ---
+typedef struct {
+	SDL_AtomicU32 head;
+	SDL_ThreadID thread_id;
+	char thread_name[32];
+	TraceRecord records[TRACE_BUFFER_RECORDS];
+} TraceBuffer;
+
+// --- Shared-memory telemetry payload; fixed-size fields only, as external readers map it directly ---
+typedef struct {
+	Uint64 publish_ns; // Writer's SDL_GetTicksNS at the last update
+	float sensor_rate_hz; // Gyro samples per second, measured over the last second
+	float gyro[3]; // Calibrated, rad/s: [0]=Pitch, [1]=Yaw, [2]=Roll
+	Uint32 has_gamepad;
+	Uint32 is_aiming;
+	Uint32 mouse_mode;
+	Uint32 flick_stick_enabled;
+	Uint64 gyro_samples;
+	Sint64 mouse_counts[2]; // Total emitted mouse counts, X and Y
+	Uint64 mouse_events_injected;
+	Uint64 pad_reports_submitted;
+	Uint64 pad_reports_suppressed;
+	Uint64 pad_reports_delivered;
+	float latency_us[LATENCY_STAGE_COUNT][3]; // p50, p99, p99.9 per LatencyStage
+} SharedTelemetry;
+
+// --- Shared-memory segment: header and seqlock on their own cache lines, then the payload ---
+typedef struct {
+	Uint32 magic;
+	Uint32 version;
+	Uint32 size; // sizeof(SharedTelemetrySegment)
+	Uint8 header_padding[64 - 3 * sizeof(Uint32)];
+	SDL_AtomicU32 sequence; // Odd while the writer is updating data
+	Uint8 sequence_padding[64 - sizeof(SDL_AtomicU32)];
+	SharedTelemetry data;
+} SharedTelemetrySegment;
+
+// --- Captured session record, as queued by the producers and returned by the capture reader ---
+typedef enum {
+	CAPTURE_SENSOR, // Raw gyro event
+	CAPTURE_BUTTON,
+	CAPTURE_AXIS,
+	CAPTURE_PACKET, // SDL_EVENT_GAMEPAD_UPDATE_COMPLETE
+	CAPTURE_AIM, // Aim state changed
+	CAPTURE_MOUSE, // Emitted mouse move
+	CAPTURE_PAD, // Virtual pad report handed to the output layer
+	CAPTURE_RECORD_TYPE_COUNT
+} CaptureRecordType;
+
+typedef enum {
+	CAPTURE_PRODUCER_INPUT, // Input thread: sensor, button, axis, packet, aim and pad records
+	CAPTURE_PRODUCER_MOUSE, // Mouse thread: mouse records
+	CAPTURE_PRODUCER_COUNT
+} CaptureProducer;
+
+typedef struct {
+	CaptureRecordType type;
+	Uint64 timestamp_ns; // SDL event timestamp for input records, emission time for output records; stored in us
+	union {
+		struct { Uint64 sensor_timestamp_ns; float data[3]; } sensor;
+		struct { Uint8 button; bool down; } button;
+		struct { Uint8 axis; Sint16 value; } axis;
+		bool aiming;
+		MouseMove mouse;
+		XUSB_REPORT pad;
+	};
+} CaptureRecord;
+
+// --- Single-producer/single-consumer queue from one capturing thread to the writer thread ---
+typedef struct {
+	SDL_AtomicU32 head; // Written by the producer only
+	char head_padding[64 - sizeof(SDL_AtomicU32)];
+	SDL_AtomicU32 tail; // Written by the writer thread only
+	char tail_padding[64 - sizeof(SDL_AtomicU32)];
+	CaptureRecord records[CAPTURE_RING_CAPACITY];
+} CaptureRing;
+
+// --- One entry of the chunk index written at the end of a capture file ---
+typedef struct {
+	Uint64 file_offset; // Of the chunk header
+	Uint64 first_timestamp_ns;
+	Uint64 last_timestamp_ns;
+	Uint32 record_count;
+} CaptureChunkInfo;
+
+// --- Main loop pacing ---
+typedef enum {
+	PACING_IDLE, // No pad, or gyro inactive: block on events
+	PACING_ACTIVE, // Aiming or calibrating: wake at the controller's packet rate
+	PACING_UI, // Window needs redraws: wake for the next frame at display refresh
+	PACING_STATE_COUNT
+} PacingState;
+
+typedef struct {
+	Uint64 iterations;
+	Uint64 wall_ns;
+	Uint64 cpu_ns; // Process CPU time, all threads
+} PacingStats;
+
 // --- Menu System Structure ---
 typedef struct {
 	const char* label;
 	void (*execute)(int direction);
 	void (*display)(char* buffer, size_t size);
+	bool (*is_visible)(void); // NULL = always shown
 } MenuItem;
 
 // --- Global Application State (declared extern) ---
+extern AppOptions app_options;
+extern bool is_headless;
 extern SDL_Window* window;
 extern SDL_Renderer* renderer;
 extern SDL_Gamepad* gamepad;
 extern SDL_JoystickID gamepad_instance_id;
 extern bool is_window_focused;
-extern bool force_one_render;
+extern SDL_AtomicInt force_one_render; // Set by the input and main threads, taken by the UI
 extern bool isAiming;
 extern AppSettings settings;
 extern bool settings_are_dirty;
 extern char current_profile_name[64];
 extern bool controller_has_led;
 extern CalibrationState calibration_state;
-extern int calibration_sample_count;
-extern float gyro_accumulator[3];
+extern CoreCalibration gyro_calibration;
 extern float flick_stick_turn_remaining;
-extern Uint64 stability_timer_start_time;
-extern float flick_last_angle;
-extern bool is_flick_stick_active;
+extern Uint64 stability_timer_start_time; // Clock_GetTicksNS when the pad went still; 0 = moving
+extern CoreFlickStick flick_stick;
 
 // --- Driver/Library State ---
+#ifdef _WIN32
 extern PVIGEM_CLIENT vigem_client;
 extern PVIGEM_TARGET x360_pad;
 extern bool vigem_found;
-extern bool is_controller_hidden;
 extern wchar_t hidden_device_instance_path[MAX_PATH];
+#else
+extern bool uinput_found;
+#endif
+extern SDL_AtomicInt is_controller_hidden; // Written by the HidHide worker
+extern PadOutputStats pad_stats;
+
+// --- Physical Pad State ---
+extern PadState pad_state;
+extern Uint64 last_pad_packet_ns; // When the active pad last sent SDL_EVENT_GAMEPAD_UPDATE_COMPLETE; 0 = never
 
 // --- Gyro Data ---
 extern float gyro_data[3];
+extern Uint64 last_gyro_sensor_timestamp;
+extern Uint64 gyro_sample_interval_ns;
 
 // --- Mouse Thread State ---
 extern volatile bool run_mouse_thread;
-extern HANDLE mouse_thread_handle;
-extern CRITICAL_SECTION data_lock;
-extern volatile float shared_gyro_data[3];
-extern volatile float shared_flick_stick_delta_x;
-extern volatile bool shared_mouse_aim_active;
+extern SDL_Thread* mouse_thread;
+extern Wakeup mouse_wakeup;
+extern MouseThreadStats mouse_stats;
+extern GyroSampleQueue gyro_queue;
+extern SDL_AtomicU32 shared_flick_stick_delta_x; // Bit pattern of a float
+extern SDL_AtomicInt shared_mouse_aim_active;
+extern SDL_AtomicInt gyro_samples_dropped;
+
+// --- Input Thread State ---
+extern volatile bool run_input_thread;
+extern SDL_Thread* input_thread;
+extern SDL_Mutex* input_lock; // Guards gamepad, settings and calibration state shared by the input and main threads
+extern Wakeup input_wakeup; // Ends an idle wait early
+extern InputThreadStats input_stats;
+
+// --- Pad Submission Thread State ---
+extern volatile bool run_pad_thread;
+extern SDL_Thread* pad_thread;
+extern Wakeup pad_wakeup;
+
+// --- Capture Writer Thread State ---
+extern volatile bool run_capture_thread;
+extern SDL_Thread* capture_thread;
+extern Wakeup capture_wakeup;
+extern CaptureRing* capture_rings[CAPTURE_PRODUCER_COUNT]; // NULL while not capturing
+extern SDL_AtomicInt capture_records_dropped;
+
+// --- Telemetry State ---
+extern TelemetryRing telemetry_ring;
+extern SDL_AtomicInt telemetry_mouse_counts[2]; // Added to by the mouse thread, taken by the input thread
+extern SDL_AtomicU32 telemetry_latency_us;
+
+// --- Latency State ---
+extern LatencyHistogram latency_histograms[LATENCY_STAGE_COUNT];
+
+// --- Main Loop Pacing State ---
+extern PacingState pacing_state;
+extern PacingStats pacing_stats[PACING_STATE_COUNT];
 
 // --- UI State ---
 extern bool is_entering_text;
@@ -116,5 +517,7 @@ extern bool is_waiting_for_aim_button;
 extern char active_menu_label[128];
 extern int visible_menu_map[];
 extern int num_visible_menu_items;
+extern bool show_telemetry;
+extern bool is_viewing_latency;
 
 #endif
\ No newline at end of file
@@ -0,0 +1,59 @@
+#include "telemetry.h"
+
+static Sint64 emitted_counts[2] = { 0 };
+
+void Telemetry_PushGyroSample(const float rate[3], Uint64 interval_ns)
+{
+	Uint32 head = SDL_GetAtomicU32(&telemetry_ring.head);
+	TelemetrySample* row = &telemetry_ring.samples[head & (TELEMETRY_CAPACITY - 1)];
+	row->gyro_rate[0] = rate[0];
+	row->gyro_rate[1] = rate[1];
+	row->gyro_rate[2] = rate[2];
+	int counts_x = SDL_SetAtomicInt(&telemetry_mouse_counts[0], 0);
+	int counts_y = SDL_SetAtomicInt(&telemetry_mouse_counts[1], 0);
+	emitted_counts[0] += counts_x;
+	emitted_counts[1] += counts_y;
+	row->mouse_counts[0] = (float)counts_x;
+	row->mouse_counts[1] = (float)counts_y;
+	row->sample_interval_ms = (float)interval_ns / 1e6f;
+	row->latency_ms = (float)SDL_GetAtomicU32(&telemetry_latency_us) / 1000.0f;
+	SDL_SetAtomicU32(&telemetry_ring.head, head + 1); // Publishes the row
+}
+
+void Telemetry_AddMouseCounts(Sint32 x, Sint32 y)
+{
+	SDL_AddAtomicInt(&telemetry_mouse_counts[0], x);
+	SDL_AddAtomicInt(&telemetry_mouse_counts[1], y);
+}
+
+void Telemetry_SetLatency(Uint64 latency_ns)
+{
+	SDL_SetAtomicU32(&telemetry_latency_us, (Uint32)(latency_ns / 1000));
+}
+
+int Telemetry_CopyRecent(TelemetrySample* out, int max_count)
+{
+	Uint32 head = SDL_GetAtomicU32(&telemetry_ring.head);
+	Uint32 count = (head < (Uint32)max_count) ? head : (Uint32)max_count;
+	for (Uint32 i = 0; i < count; ++i) {
+		out[i] = telemetry_ring.samples[(head - count + i) & (TELEMETRY_CAPACITY - 1)];
+	}
+
+	// The writer never waits, so drop the oldest rows whose slots it may have reused (or be writing) meanwhile.
+	Uint32 written = SDL_GetAtomicU32(&telemetry_ring.head) - head + 1;
+	Uint32 lapped = (written + count > TELEMETRY_CAPACITY) ? written + count - TELEMETRY_CAPACITY : 0;
+	if (lapped >= count) return 0;
+	if (lapped > 0) SDL_memmove(out, out + lapped, (count - lapped) * sizeof(*out));
+	return (int)(count - lapped);
+}
+
+Uint32 Telemetry_GetRevision(void)
+{
+	return SDL_GetAtomicU32(&telemetry_ring.head);
+}
+
+void Telemetry_GetEmittedCounts(Sint64 counts[2])
+{
+	counts[0] = emitted_counts[0];
+	counts[1] = emitted_counts[1];
+}
\ No newline at end of file
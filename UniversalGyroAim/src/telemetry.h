@@ -0,0 +1,17 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "state.h"
+
+// Live telemetry for the UI chart. The input thread appends one row per gyro sample; the mouse thread and the
+// pad report path contribute through atomics that the next row picks up.
+void Telemetry_PushGyroSample(const float rate[3], Uint64 interval_ns);
+void Telemetry_AddMouseCounts(Sint32 x, Sint32 y);
+void Telemetry_SetLatency(Uint64 latency_ns);
+// Copies up to max_count of the newest rows, oldest first. Returns the number copied.
+int Telemetry_CopyRecent(TelemetrySample* out, int max_count);
+Uint32 Telemetry_GetRevision(void);
+// Totals of the mouse counts picked up so far. Input thread only.
+void Telemetry_GetEmittedCounts(Sint64 counts[2]);
+
+#endif
\ No newline at end of file
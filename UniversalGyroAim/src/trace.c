@@ -0,0 +1,128 @@
+#include "trace.h"
+#include <stdio.h>
+
+#ifdef UGA_ENABLE_TRACE
+
+static TraceBuffer* trace_buffers[TRACE_MAX_THREADS];
+static SDL_AtomicInt trace_buffer_count = { 0 };
+static SDL_TLSID trace_tls = { 0 };
+static char untraced_thread; // TLS marker for threads beyond TRACE_MAX_THREADS
+
+// Claims a buffer for the calling thread on its first record.
+static TraceBuffer* GetThreadBuffer(void)
+{
+	void* value = SDL_GetTLS(&trace_tls);
+	if (value == &untraced_thread) return NULL;
+	if (value) return (TraceBuffer*)value;
+
+	int index = SDL_AddAtomicInt(&trace_buffer_count, 1);
+	TraceBuffer* buffer = (index < TRACE_MAX_THREADS) ? (TraceBuffer*)SDL_calloc(1, sizeof(TraceBuffer)) : NULL;
+	if (!buffer) {
+		SDL_SetTLS(&trace_tls, &untraced_thread, NULL);
+		return NULL;
+	}
+	buffer->thread_id = SDL_GetCurrentThreadID();
+	SDL_snprintf(buffer->thread_name, sizeof(buffer->thread_name), "Thread %d", index);
+	SDL_SetAtomicPointer((void**)&trace_buffers[index], buffer);
+	SDL_SetTLS(&trace_tls, buffer, NULL);
+	return buffer;
+}
+
+void Trace_RegisterThread(const char* name)
+{
+	TraceBuffer* buffer = GetThreadBuffer();
+	if (buffer) strcpy_s(buffer->thread_name, sizeof(buffer->thread_name), name);
+}
+
+void Trace_Record(const char* name, char phase)
+{
+	TraceBuffer* buffer = GetThreadBuffer();
+	if (!buffer) return;
+	Uint32 head = SDL_GetAtomicU32(&buffer->head);
+	TraceRecord* record = &buffer->records[head & (TRACE_BUFFER_RECORDS - 1)];
+	record->timestamp_ns = SDL_GetTicksNS();
+	record->name = name;
+	record->phase = phase;
+	SDL_SetAtomicU32(&buffer->head, head + 1); // Publishes the record
+}
+
+// The owner keeps recording while the ring is read, so the records are copied out first and the head is read again
+// afterwards: any record the owner may have reached in the meantime is dropped rather than written torn.
+static void WriteThreadRecords(FILE* file, const TraceBuffer* buffer, TraceRecord* copy, Uint64 since_ns, bool* first)
+{
+	Uint32 head = SDL_GetAtomicU32((SDL_AtomicU32*)&buffer->head);
+	Uint32 count = (head < TRACE_BUFFER_RECORDS) ? head : TRACE_BUFFER_RECORDS;
+	Uint32 start = head - count;
+	for (Uint32 i = start; i != head; ++i) {
+		copy[i - start] = buffer->records[i & (TRACE_BUFFER_RECORDS - 1)];
+	}
+	Uint32 head_after = SDL_GetAtomicU32((SDL_AtomicU32*)&buffer->head);
+
+	fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%llu,\"args\":{\"name\":\"%s\"}}",
+		*first ? "" : ",\n", (unsigned long long)buffer->thread_id, buffer->thread_name);
+	*first = false;
+	for (Uint32 i = start; i != head; ++i) {
+		// Record i shares its slot with record i + TRACE_BUFFER_RECORDS, which the owner may have started by now.
+		if (head_after - i >= TRACE_BUFFER_RECORDS) continue;
+		const TraceRecord* record = &copy[i - start];
+		if (record->timestamp_ns < since_ns || !record->name) continue;
+		fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%llu}",
+			record->name, record->phase, record->timestamp_ns / 1e3, (unsigned long long)buffer->thread_id);
+	}
+}
+
+bool Trace_Dump(const char* path, Uint64 seconds)
+{
+	TraceRecord* copy = (TraceRecord*)SDL_malloc(sizeof(TraceRecord) * TRACE_BUFFER_RECORDS); // One ring at a time
+	FILE* file = NULL;
+	if (!copy || fopen_s(&file, path, "w") != 0 || !file) {
+		SDL_Log("Error: Could not write trace to %s.", path);
+		SDL_free(copy);
+		return false;
+	}
+
+	Uint64 now = SDL_GetTicksNS();
+	Uint64 since_ns = (now > SDL_SECONDS_TO_NS(seconds)) ? now - SDL_SECONDS_TO_NS(seconds) : 0;
+	int buffer_count = SDL_GetAtomicInt(&trace_buffer_count);
+	if (buffer_count > TRACE_MAX_THREADS) buffer_count = TRACE_MAX_THREADS;
+
+	bool first = true;
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	for (int i = 0; i < buffer_count; ++i) {
+		const TraceBuffer* buffer = (const TraceBuffer*)SDL_GetAtomicPointer((void**)&trace_buffers[i]);
+		if (buffer) WriteThreadRecords(file, buffer, copy, since_ns, &first);
+	}
+	fprintf(file, "\n]}\n");
+	fclose(file);
+	SDL_free(copy);
+	SDL_Log("Trace of the last %llu s written to %s.", (unsigned long long)seconds, path);
+	return true;
+}
+
+// Call only once every traced thread has stopped.
+void Trace_Shutdown(void)
+{
+	int buffer_count = SDL_GetAtomicInt(&trace_buffer_count);
+	for (int i = 0; i < buffer_count && i < TRACE_MAX_THREADS; ++i) {
+		SDL_free(trace_buffers[i]);
+		trace_buffers[i] = NULL;
+	}
+	SDL_SetAtomicInt(&trace_buffer_count, 0);
+	SDL_SetTLS(&trace_tls, NULL, NULL);
+}
+
+#else
+
+void Trace_RegisterThread(const char* name) { (void)name; }
+void Trace_Record(const char* name, char phase) { (void)name; (void)phase; }
+
+bool Trace_Dump(const char* path, Uint64 seconds)
+{
+	(void)path; (void)seconds;
+	SDL_Log("Tracing is not available in this build; rebuild with UGA_ENABLE_TRACE (Debug configurations).");
+	return false;
+}
+
+void Trace_Shutdown(void) {}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,24 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "state.h"
+
+// Span tracing into per-thread rings, dumped as Chrome trace JSON (chrome://tracing, ui.perfetto.dev).
+// Only built with UGA_ENABLE_TRACE (Debug configurations); otherwise the macros compile to nothing.
+#ifdef UGA_ENABLE_TRACE
+#define TRACE_THREAD(name) Trace_RegisterThread(name)
+#define TRACE_BEGIN(name) Trace_Record((name), 'B')
+#define TRACE_END(name) Trace_Record((name), 'E')
+#else
+#define TRACE_THREAD(name) ((void)0)
+#define TRACE_BEGIN(name) ((void)0)
+#define TRACE_END(name) ((void)0)
+#endif
+
+void Trace_RegisterThread(const char* name);
+void Trace_Record(const char* name, char phase);
+// Writes the last `seconds` of every thread's records. Returns false if tracing is compiled out or the file failed.
+bool Trace_Dump(const char* path, Uint64 seconds);
+void Trace_Shutdown(void);
+
+#endif
\ No newline at end of file
@@ -2,9 +2,14 @@
 #include "app.h"
 #include "config.h"
 #include "hidhide.h"
-#include <shlwapi.h>
-#pragma comment(lib, "shlwapi.lib")
+#include "input.h"
+#include "visualizer.h"
+#include "telemetry.h"
+#include "latency.h"
+#include "trace.h"
+#include "clock.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 #include <math.h>
@@ -38,28 +43,55 @@ void execute_load_profile(int direction);
 void display_profile_count(char* buffer, size_t size);
 void execute_save_profile(int direction);
 void display_current_profile(char* buffer, size_t size);
+void execute_telemetry(int direction);
+void display_telemetry(char* buffer, size_t size);
+void execute_latency(int direction);
 void execute_reset_app(int direction);
 
+// Input state as of the current frame; menu display functions and drawing read this, never the live state.
+static InputSnapshot ui_view;
+
+// --- Menu visibility conditions ---
+static bool show_without_flick_stick(void) { return !ui_view.settings.flick_stick_enabled; }
+static bool show_with_flick_stick(void) { return ui_view.settings.flick_stick_enabled; }
+static bool show_in_mouse_mode(void) { return ui_view.settings.mouse_mode; }
+static bool show_in_joystick_mode(void) { return !ui_view.settings.mouse_mode; }
+static bool show_with_led(void) { return ui_view.controller_has_led; }
+
 // --- Menu Definition (Master List) ---
 static MenuItem menu_items[] = {
-	{ "Mode",                  execute_mode,                display_mode },
-	{ "Sensitivity",           execute_sensitivity,         display_sensitivity },
-	{ "Always-On Gyro",        execute_always_on,           display_always_on },
-	{ "Flick Stick",           execute_flick_stick,         display_flick_stick },
-	{ "Anti-Deadzone",         execute_anti_deadzone,       display_anti_deadzone },
-	{ "Invert Gyro Y",         execute_invert_y,            display_invert_y },
-	{ "Invert Gyro X",         execute_invert_x,            display_invert_x },
-	{ "Aim Button",            execute_change_aim_button,   display_change_aim_button },
-	{ "Calibrate Gyro",        execute_calibrate_gyro,      display_gyro_calibration },
-	{ "Calibrate Flick Stick", execute_calibrate_flick,     display_flick_calibration },
-	{ "LED Color",             execute_change_led,          display_led_color },
-	{ "Hide Controller",       execute_hide_controller,     display_hide_controller },
-	{ "Load Profile",          execute_load_profile,        display_profile_count  },
-	{ "Save Profile",          execute_save_profile,        display_current_profile },
-	{ "Reset Application",     execute_reset_app,           NULL }
+	{ "Mode",                  execute_mode,                display_mode,                show_without_flick_stick },
+	{ "Sensitivity",           execute_sensitivity,         display_sensitivity,         NULL },
+	{ "Always-On Gyro",        execute_always_on,           display_always_on,           show_without_flick_stick },
+	{ "Flick Stick",           execute_flick_stick,         display_flick_stick,         show_in_mouse_mode },
+	{ "Anti-Deadzone",         execute_anti_deadzone,       display_anti_deadzone,       show_in_joystick_mode },
+	{ "Invert Gyro Y",         execute_invert_y,            display_invert_y,            NULL },
+	{ "Invert Gyro X",         execute_invert_x,            display_invert_x,            NULL },
+	{ "Aim Button",            execute_change_aim_button,   display_change_aim_button,   NULL },
+	{ "Calibrate Gyro",        execute_calibrate_gyro,      display_gyro_calibration,    NULL },
+	{ "Calibrate Flick Stick", execute_calibrate_flick,     display_flick_calibration,   show_with_flick_stick },
+	{ "LED Color",             execute_change_led,          display_led_color,           show_with_led },
+	{ "Hide Controller",       execute_hide_controller,     display_hide_controller,     NULL },
+	{ "Load Profile",          execute_load_profile,        display_profile_count,       NULL },
+	{ "Save Profile",          execute_save_profile,        display_current_profile,     NULL },
+	{ "Telemetry",             execute_telemetry,           display_telemetry,           NULL },
+	{ "Latency Stats",         execute_latency,             NULL,                        NULL },
+	{ "Reset Application",     execute_reset_app,           NULL,                        NULL }
 };
 static const int master_num_menu_items = sizeof(menu_items) / sizeof(MenuItem);
 
+// --- Retained menu: rebuilt only when the input snapshot revision or UI-local state changes ---
+static bool menu_cache_valid = false;
+static Uint32 menu_cache_revision = 0;
+static char menu_value_cache[32][128]; // Per visible item, like visible_menu_map
+static int cached_profile_count = -1; // -1 = rescan on next use
+static bool ui_state_changed = true; // Menu selection, text entry or profile chooser changed
+static int last_indicator_x = 0, last_indicator_y = 0;
+static bool last_indicator_active = false;
+static Uint32 last_telemetry_revision = 0;
+static Uint64 last_latency_count = 0;
+static TelemetrySample telemetry_rows[TELEMETRY_CHART_POINTS];
+
 
 // --- Profile Scanning Helpers ---
 static void FreeProfileList() {
@@ -71,42 +103,34 @@ static void FreeProfileList() {
 	num_profiles = 0;
 }
 
-static void GetProfilesDir(char* buffer, size_t size) {
-	GetModuleFileNameA(NULL, buffer, (DWORD)size);
-	PathRemoveFileSpecA(buffer);
-	PathAppendA(buffer, PROFILES_DIRECTORY);
+// Returns the .ini files in the profiles directory; free the result with SDL_free.
+static char** GlobProfiles(int* count) {
+	*count = 0;
+	char dir_path[MAX_PATH];
+	if (!GetProfilesDir(dir_path, MAX_PATH)) return NULL;
+	return SDL_GlobDirectory(dir_path, "*.ini", SDL_GLOB_CASEINSENSITIVE, count);
 }
 
 static void ScanForProfiles() {
 	FreeProfileList();
-	char search_path[MAX_PATH];
-	GetProfilesDir(search_path, MAX_PATH);
-	PathAppendA(search_path, "*.ini");
-
-	WIN32_FIND_DATAA find_data;
-	HANDLE find_handle = FindFirstFileA(search_path, &find_data);
-	if (find_handle == INVALID_HANDLE_VALUE) return;
-
-	char** temp_list = NULL;
-	int capacity = 0;
-	do {
-		if (!(find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
-			if (num_profiles >= capacity) {
-				capacity = (capacity == 0) ? 8 : capacity * 2;
-				temp_list = (char**)realloc(profile_filenames, capacity * sizeof(char*));
-				if (!temp_list) { FindClose(find_handle); FreeProfileList(); return; }
-				profile_filenames = temp_list;
-			}
-			profile_filenames[num_profiles] = _strdup(find_data.cFileName);
+	int count = 0;
+	char** found = GlobProfiles(&count);
+	if (!found) return;
+
+	if (count > 0) {
+		profile_filenames = (char**)malloc(count * sizeof(char*));
+		if (!profile_filenames) { SDL_free(found); return; }
+		for (int i = 0; i < count; ++i) {
+			profile_filenames[num_profiles] = _strdup(found[i]);
 			num_profiles++;
 		}
-	} while (FindNextFileA(find_handle, &find_data) != 0);
-	FindClose(find_handle);
+	}
+	SDL_free(found);
 }
 
 // --- Menu Functions ---
 void execute_mode(int d) { if (d == 0) { settings.mouse_mode = !settings.mouse_mode; settings_are_dirty = true; } }
-void display_mode(char* b, size_t s) { snprintf(b, s, "%s", settings.mouse_mode ? "Mouse" : "Joystick"); }
+void display_mode(char* b, size_t s) { snprintf(b, s, "%s", ui_view.settings.mouse_mode ? "Mouse" : "Joystick"); }
 void execute_sensitivity(int d) {
 	if (d == 0) return;
 	if (settings.mouse_mode) {
@@ -120,19 +144,18 @@ void execute_sensitivity(int d) {
 	settings_are_dirty = true;
 }
 void display_sensitivity(char* b, size_t s) {
-	if (settings.mouse_mode) snprintf(b, s, "%.0f", settings.mouse_sensitivity);
-	else snprintf(b, s, "%.1f", settings.sensitivity);
+	if (ui_view.settings.mouse_mode) snprintf(b, s, "%.0f", ui_view.settings.mouse_sensitivity);
+	else snprintf(b, s, "%.1f", ui_view.settings.sensitivity);
 }
 void execute_flick_stick(int d) {
 	if (d == 0) {
 		settings.flick_stick_enabled = !settings.flick_stick_enabled;
 		settings.always_on_gyro = settings.flick_stick_enabled;
-		is_flick_stick_active = false;
-		flick_last_angle = 0.0f;
+		SDL_zero(flick_stick);
 		settings_are_dirty = true;
 	}
 }
-void display_flick_stick(char* b, size_t s) { snprintf(b, s, "%s", settings.flick_stick_enabled ? "ON" : "OFF"); }
+void display_flick_stick(char* b, size_t s) { snprintf(b, s, "%s", ui_view.settings.flick_stick_enabled ? "ON" : "OFF"); }
 void execute_always_on(int d) {
 	if (d == 0 && !settings.flick_stick_enabled) {
 		settings.always_on_gyro = !settings.always_on_gyro;
@@ -140,23 +163,23 @@ void execute_always_on(int d) {
 		settings_are_dirty = true;
 	}
 }
-void display_always_on(char* b, size_t s) { snprintf(b, s, "%s", settings.always_on_gyro ? "ON" : "OFF"); }
+void display_always_on(char* b, size_t s) { snprintf(b, s, "%s", ui_view.settings.always_on_gyro ? "ON" : "OFF"); }
 void execute_anti_deadzone(int d) {
 	if (d == 0) return;
 	settings.anti_deathzone += (float)d * 1.0f;
 	settings.anti_deathzone = CLAMP(settings.anti_deathzone, 0.0f, 90.0f);
 	settings_are_dirty = true;
 }
-void display_anti_deadzone(char* b, size_t s) { snprintf(b, s, "%.0f%%", settings.anti_deathzone); }
+void display_anti_deadzone(char* b, size_t s) { snprintf(b, s, "%.0f%%", ui_view.settings.anti_deathzone); }
 void execute_invert_y(int d) { if (d == 0) { settings.invert_gyro_y = !settings.invert_gyro_y; settings_are_dirty = true; } }
-void display_invert_y(char* b, size_t s) { snprintf(b, s, "%s", settings.invert_gyro_y ? "ON" : "OFF"); }
+void display_invert_y(char* b, size_t s) { snprintf(b, s, "%s", ui_view.settings.invert_gyro_y ? "ON" : "OFF"); }
 void execute_invert_x(int d) { if (d == 0) { settings.invert_gyro_x = !settings.invert_gyro_x; settings_are_dirty = true; } }
-void display_invert_x(char* b, size_t s) { snprintf(b, s, "%s", settings.invert_gyro_x ? "ON" : "OFF"); }
+void display_invert_x(char* b, size_t s) { snprintf(b, s, "%s", ui_view.settings.invert_gyro_x ? "ON" : "OFF"); }
 void execute_change_aim_button(int d) { if (d == 0) { is_waiting_for_aim_button = true; settings.selected_button = -1; settings.selected_axis = -1; isAiming = false; } }
 void display_change_aim_button(char* b, size_t s) {
-	if (is_waiting_for_aim_button) snprintf(b, s, "[Waiting for input...]");
-	else if (settings.selected_button != -1) snprintf(b, s, "%s", SDL_GetGamepadStringForButton(settings.selected_button));
-	else if (settings.selected_axis != -1) snprintf(b, s, "%s", SDL_GetGamepadStringForAxis(settings.selected_axis));
+	if (ui_view.is_waiting_for_aim_button) snprintf(b, s, "[Waiting for input...]");
+	else if (ui_view.settings.selected_button != -1) snprintf(b, s, "%s", SDL_GetGamepadStringForButton(ui_view.settings.selected_button));
+	else if (ui_view.settings.selected_axis != -1) snprintf(b, s, "%s", SDL_GetGamepadStringForAxis(ui_view.settings.selected_axis));
 	else snprintf(b, s, "[Not set]");
 }
 void execute_calibrate_gyro(int d) {
@@ -165,13 +188,13 @@ void execute_calibrate_gyro(int d) {
 		stability_timer_start_time = 0;
 	}
 }
-void display_gyro_calibration(char* b, size_t s) { snprintf(b, s, "P:%.3f Y:%.3f", settings.gyro_calibration_offset[0], settings.gyro_calibration_offset[1]); }
+void display_gyro_calibration(char* b, size_t s) { snprintf(b, s, "P:%.3f Y:%.3f", ui_view.settings.gyro_calibration_offset[0], ui_view.settings.gyro_calibration_offset[1]); }
 void execute_calibrate_flick(int d) {
 	if (d == 0 && gamepad && calibration_state == CALIBRATION_IDLE) {
 		calibration_state = FLICK_STICK_CALIBRATION_START;
 	}
 }
-void display_flick_calibration(char* b, size_t s) { snprintf(b, s, "%.1f%s", settings.flick_stick_calibration_value, settings.flick_stick_calibrated ? "" : " (Default)"); }
+void display_flick_calibration(char* b, size_t s) { snprintf(b, s, "%.1f%s", ui_view.settings.flick_stick_calibration_value, ui_view.settings.flick_stick_calibrated ? "" : " (Default)"); }
 void execute_change_led(int d) {
 	if (d == 0) {
 		is_entering_text = true;
@@ -181,18 +204,19 @@ void execute_change_led(int d) {
 }
 void display_led_color(char* b, size_t s) {
 	if (is_entering_text) snprintf(b, s, "%s", hex_input_buffer);
-	else snprintf(b, s, "#%02X%02X%02X", settings.led_r, settings.led_g, settings.led_b);
+	else snprintf(b, s, "#%02X%02X%02X", ui_view.settings.led_r, ui_view.settings.led_g, ui_view.settings.led_b);
 }
 void execute_hide_controller(int d) {
 	if (d == 0 && gamepad) {
-		if (is_controller_hidden) UnhidePhysicalController();
+		if (ui_view.is_controller_hidden) UnhidePhysicalController();
 		else HidePhysicalController(gamepad);
 	}
 }
-void display_hide_controller(char* b, size_t s) { snprintf(b, s, "%s", is_controller_hidden ? "Hidden" : "Visible"); }
+void display_hide_controller(char* b, size_t s) { snprintf(b, s, "%s", ui_view.is_controller_hidden ? "Hidden" : "Visible"); }
 void execute_load_profile(int d) {
 	if (d == 0) {
 		ScanForProfiles();
+		cached_profile_count = num_profiles;
 		if (num_profiles > 0) {
 			is_choosing_profile = true;
 			selected_profile_index = 0;
@@ -200,17 +224,12 @@ void execute_load_profile(int d) {
 	}
 }
 void display_profile_count(char* b, size_t s) {
-	char search_path[MAX_PATH];
-	GetProfilesDir(search_path, MAX_PATH);
-	PathAppendA(search_path, "*.ini");
-	WIN32_FIND_DATAA fd;
-	HANDLE hFind = FindFirstFileA(search_path, &fd);
-	int count = 0;
-	if (hFind != INVALID_HANDLE_VALUE) {
-		do { if (!(fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) count++; } while (FindNextFileA(hFind, &fd) != 0);
-		FindClose(hFind);
+	if (cached_profile_count < 0) {
+		int count = 0;
+		SDL_free(GlobProfiles(&count));
+		cached_profile_count = count;
 	}
-	snprintf(b, s, "[%d]", count);
+	snprintf(b, s, "[%d]", cached_profile_count);
 }
 void execute_save_profile(int d) {
 	if (d == 0) {
@@ -219,49 +238,34 @@ void execute_save_profile(int d) {
 		SDL_StartTextInput(window);
 	}
 }
-void display_current_profile(char* b, size_t s) { snprintf(b, s, "%s%s", current_profile_name, settings_are_dirty ? "*" : ""); }
+void display_current_profile(char* b, size_t s) { snprintf(b, s, "%s%s", ui_view.profile_name, ui_view.settings_are_dirty ? "*" : ""); }
+void execute_telemetry(int d) {
+	if (d != 0) return;
+	show_telemetry = !show_telemetry;
+	// The chart gets its own strip below the menu rather than crowding it.
+	int w, h;
+	if (window && SDL_GetWindowSize(window, &w, &h)) SDL_SetWindowSize(window, w, h + (show_telemetry ? TELEMETRY_PANEL_HEIGHT : -TELEMETRY_PANEL_HEIGHT));
+}
+void display_telemetry(char* b, size_t s) { snprintf(b, s, "%s", show_telemetry ? "ON" : "OFF"); }
+void execute_latency(int d) { if (d == 0) is_viewing_latency = true; }
 void execute_reset_app(int d) { if (d == 0) App_Reset(); }
 
 // --- Drawing Helpers ---
-static void DrawFilledCircle(SDL_Renderer* renderer, int x, int y, int radius)
-{
-	int offsetx, offsety, d;
-	offsetx = 0; offsety = radius; d = radius - 1;
-	while (offsety >= offsetx) {
-		SDL_RenderLine(renderer, x - offsety, y + offsetx, x + offsety, y + offsetx);
-		SDL_RenderLine(renderer, x - offsetx, y + offsety, x + offsetx, y + offsety);
-		SDL_RenderLine(renderer, x - offsetx, y - offsety, x + offsetx, y - offsety);
-		SDL_RenderLine(renderer, x - offsety, y - offsetx, x + offsety, y - offsetx);
-		if (d >= 2 * offsetx) {
-			d -= 2 * offsetx + 1; offsetx++;
-		}
-		else if (d < 2 * (radius - offsety)) {
-			d += 2 * offsety - 1; offsety--;
-		}
-		else { d += 2 * (offsety - offsetx - 1); offsety--; offsetx++; }
-	}
-}
-static void DrawCircle(SDL_Renderer* renderer, int centreX, int centreY, int radius) {
-	const int32_t diameter = (radius * 2);
-	int32_t x = (radius - 1); int32_t y = 0; int32_t tx = 1; int32_t ty = 1; int32_t error = (tx - diameter);
-	while (x >= y) {
-		SDL_RenderPoint(renderer, centreX + x, centreY - y); SDL_RenderPoint(renderer, centreX + x, centreY + y);
-		SDL_RenderPoint(renderer, centreX - x, centreY - y); SDL_RenderPoint(renderer, centreX - x, centreY + y);
-		SDL_RenderPoint(renderer, centreX + y, centreY - x); SDL_RenderPoint(renderer, centreX + y, centreY + x);
-		SDL_RenderPoint(renderer, centreX - y, centreY - x); SDL_RenderPoint(renderer, centreX - y, centreY + x);
-		if (error <= 0) { ++y; error += ty; ty += 2; }
-		if (error > 0) { --x; tx += 2; error += (tx - diameter); }
-	}
-}
-
 // --- Event Handlers ---
 void UI_HandleKeyEvent(SDL_Event* event) {
+	ui_state_changed = true;
+	if (event->key.key == SDLK_F9) {
+		char trace_path[MAX_PATH];
+		snprintf(trace_path, sizeof(trace_path), "%s%s", SDL_GetBasePath() ? SDL_GetBasePath() : "", TRACE_JSON_FILENAME);
+		Trace_Dump(trace_path, TRACE_DUMP_SECONDS);
+		return;
+	}
 	if (is_entering_save_filename) {
 		if (event->key.key == SDLK_BACKSPACE && strlen(filename_input_buffer) > 0) {
 			filename_input_buffer[strlen(filename_input_buffer) - 1] = '\0';
 		}
 		else if (event->key.key == SDLK_RETURN || event->key.key == SDLK_KP_ENTER) {
-			if (strlen(filename_input_buffer) > 0) SaveSettings(filename_input_buffer);
+			if (strlen(filename_input_buffer) > 0) { SaveSettings(filename_input_buffer); cached_profile_count = -1; }
 			is_entering_save_filename = false; SDL_StopTextInput(window);
 		}
 		else if (event->key.key == SDLK_ESCAPE) {
@@ -279,6 +283,10 @@ void UI_HandleKeyEvent(SDL_Event* event) {
 		}
 		return;
 	}
+	if (is_viewing_latency) {
+		if (event->key.key == SDLK_ESCAPE || event->key.key == SDLK_RETURN || event->key.key == SDLK_KP_ENTER) is_viewing_latency = false;
+		return;
+	}
 	if (is_entering_text) {
 		if (event->key.key == SDLK_BACKSPACE && strlen(hex_input_buffer) > 1) {
 			hex_input_buffer[strlen(hex_input_buffer) - 1] = '\0';
@@ -319,6 +327,7 @@ void UI_HandleKeyEvent(SDL_Event* event) {
 }
 
 void UI_HandleTextInputEvent(SDL_Event* event) {
+	ui_state_changed = true;
 	if (is_entering_text) {
 		if (strlen(hex_input_buffer) < 7) strcat_s(hex_input_buffer, sizeof(hex_input_buffer), event->text.text);
 	}
@@ -336,16 +345,34 @@ void UI_HandleTextInputEvent(SDL_Event* event) {
 static void BuildVisibleMenu(void) {
 	num_visible_menu_items = 0;
 	for (int i = 0; i < master_num_menu_items; ++i) {
-		bool show = true;
-		const char* label = menu_items[i].label;
-		if ((strcmp(label, "Mode") == 0 || strcmp(label, "Always-On Gyro") == 0) && settings.flick_stick_enabled) show = false;
-		else if (strcmp(label, "Flick Stick") == 0 && !settings.mouse_mode) show = false;
-		else if (strcmp(label, "Calibrate Flick Stick") == 0 && !settings.flick_stick_enabled) show = false;
-		else if (strcmp(label, "Anti-Deadzone") == 0 && settings.mouse_mode) show = false;
-		else if (strcmp(label, "LED Color") == 0 && !controller_has_led) show = false;
-		if (show) visible_menu_map[num_visible_menu_items++] = i;
+		if (!menu_items[i].is_visible || menu_items[i].is_visible()) visible_menu_map[num_visible_menu_items++] = i;
 	}
 	if (selected_menu_item >= num_visible_menu_items) selected_menu_item = num_visible_menu_items > 0 ? num_visible_menu_items - 1 : 0;
+
+	if (active_menu_label[0] != '\0') {
+		for (int i = 0; i < num_visible_menu_items; ++i) {
+			if (strcmp(menu_items[visible_menu_map[i]].label, active_menu_label) == 0) {
+				selected_menu_item = i; break;
+			}
+		}
+		active_menu_label[0] = '\0';
+	}
+}
+
+static void RefreshMenuCache(void) {
+	BuildVisibleMenu();
+	for (int i = 0; i < num_visible_menu_items; ++i) {
+		const MenuItem* item = &menu_items[visible_menu_map[i]];
+		if (item->display) item->display(menu_value_cache[i], sizeof(menu_value_cache[i]));
+		else menu_value_cache[i][0] = '\0';
+	}
+	menu_cache_revision = ui_view.revision;
+	menu_cache_valid = true;
+}
+
+void UI_Invalidate(void) {
+	ui_state_changed = true;
+	cached_profile_count = -1; // Profiles may have been added or removed outside the app
 }
 
 static void RenderStatusMessage(const char* msg1, const char* msg2, const char* msg3) {
@@ -371,11 +398,27 @@ static void RenderStatusMessage(const char* msg1, const char* msg2, const char*
 }
 
 void UI_Render(void) {
-	if (!is_window_focused && calibration_state == CALIBRATION_IDLE && !force_one_render) {
-		SDL_Delay(1);
-		return;
-	}
-	force_one_render = false;
+	Input_GetSnapshot(&ui_view);
+	bool menu_changed = !menu_cache_valid || ui_view.revision != menu_cache_revision || ui_state_changed;
+	if (menu_changed) RefreshMenuCache();
+
+	// Position of the live gyro indicator, relative to the visualizer centre.
+	const int oR = VISUALIZER_OUTER_RADIUS;
+	float dx = ui_view.gyro_data[1] * 20.f * (ui_view.settings.invert_gyro_x ? 1.f : -1.f);
+	float dy = -ui_view.gyro_data[0] * 20.f * (ui_view.settings.invert_gyro_y ? -1.f : 1.f);
+	float dist = sqrtf(dx * dx + dy * dy);
+	if (dist > oR) { dx = (dx / dist) * oR; dy = (dy / dist) * oR; }
+	bool gyro_is_active = ui_view.is_aiming || ui_view.settings.always_on_gyro;
+	bool indicator_moved = (int)dx != last_indicator_x || (int)dy != last_indicator_y || gyro_is_active != last_indicator_active;
+
+	// Nothing on screen changed: keep the last presented frame.
+	bool telemetry_changed = show_telemetry && Telemetry_GetRevision() != last_telemetry_revision;
+	bool latency_changed = is_viewing_latency && Latency_GetTotalCount() != last_latency_count;
+	bool forced = SDL_SetAtomicInt(&force_one_render, 0) != 0; // Taken before drawing, so a request made meanwhile gets its own frame
+	if (!menu_changed && !indicator_moved && !telemetry_changed && !latency_changed && !forced && ui_view.calibration_state == CALIBRATION_IDLE) return;
+	TRACE_BEGIN("UI_Render");
+	ui_state_changed = false;
+	last_indicator_x = (int)dx; last_indicator_y = (int)dy; last_indicator_active = gyro_is_active;
 
 	SDL_SetRenderDrawColor(renderer, 25, 25, 40, 255);
 	SDL_RenderClear(renderer);
@@ -385,15 +428,22 @@ void UI_Render(void) {
 	const float line_height = (float)(SDL_DEBUG_TEXT_FONT_CHARACTER_SIZE + 4);
 	float y_pos;
 
+#ifdef _WIN32
 	if (!vigem_found) {
 		SDL_SetRenderDrawColor(renderer, 255, 100, 100, 255);
 		RenderStatusMessage("CRITICAL ERROR: ViGEmBus driver not found!", "Please install it from:", "github.com/ViGEm/ViGEmBus/releases");
 	}
-	else if (!gamepad) {
+#else
+	if (!uinput_found) {
+		SDL_SetRenderDrawColor(renderer, 255, 100, 100, 255);
+		RenderStatusMessage("CRITICAL ERROR: Could not open /dev/uinput!", "Load the uinput module and grant", "your user write access to it.");
+	}
+#endif
+	else if (!ui_view.has_gamepad) {
 		SDL_SetRenderDrawColor(renderer, 200, 200, 255, 255);
 		RenderStatusMessage(NULL, "Waiting for physical controller...", NULL);
 	}
-	else if (is_waiting_for_aim_button) {
+	else if (ui_view.is_waiting_for_aim_button) {
 		SDL_SetRenderDrawColor(renderer, 255, 255, 100, 255);
 		RenderStatusMessage("SET AIM BUTTON", "Press a button or pull a trigger.", "Press ESC to cancel.");
 	}
@@ -421,12 +471,35 @@ void UI_Render(void) {
 			y_pos += line_height;
 		}
 	}
-	else if (calibration_state != CALIBRATION_IDLE) {
+	else if (is_viewing_latency) {
+		last_latency_count = Latency_GetTotalCount();
+		y_pos = 10.0f;
+		const char* title = "LATENCY, MICROSECONDS (ESC to close)";
+		SDL_SetRenderDrawColor(renderer, 255, 255, 100, 255);
+		SDL_RenderDebugText(renderer, (w - (float)SDL_DEBUG_TEXT_FONT_CHARACTER_SIZE * strlen(title)) / 2.0f, y_pos, title);
+		y_pos += line_height * 2.0f;
+
+		char buffer[128];
+		snprintf(buffer, sizeof(buffer), "%-18s %7s %7s %7s %7s", "Stage", "Count", "p50", "p99", "p99.9");
+		SDL_SetRenderDrawColor(renderer, 200, 200, 255, 255);
+		SDL_RenderDebugText(renderer, 5.0f, y_pos, buffer);
+		y_pos += line_height * 1.2f;
+		for (int stage = 0; stage < LATENCY_STAGE_COUNT; ++stage) {
+			LatencySummary summary;
+			Latency_GetSummary((LatencyStage)stage, &summary);
+			if (summary.count == 0) snprintf(buffer, sizeof(buffer), "%-18s %7s", Latency_GetStageName((LatencyStage)stage), "-");
+			else snprintf(buffer, sizeof(buffer), "%-18s %7llu %7.0f %7.0f %7.0f", Latency_GetStageName((LatencyStage)stage),
+				(unsigned long long)summary.count, summary.p50_ns / 1e3, summary.p99_ns / 1e3, summary.p999_ns / 1e3);
+			SDL_RenderDebugText(renderer, 5.0f, y_pos, buffer);
+			y_pos += line_height * 1.2f;
+		}
+	}
+	else if (ui_view.calibration_state != CALIBRATION_IDLE) {
 		y_pos = (h - (float)SDL_DEBUG_TEXT_FONT_CHARACTER_SIZE * 7) / 2.0f;
 		char buffer[128];
 		SDL_SetRenderDrawColor(renderer, 0, 128, 255, 255);
 
-		if (calibration_state == CALIBRATION_WAITING_FOR_STABILITY) {
+		if (ui_view.calibration_state == CALIBRATION_WAITING_FOR_STABILITY) {
 			const char* msg1 = "GYRO CALIBRATION: WAITING FOR STABILITY...";
 			const char* msg2 = "Press (B) on controller to cancel.";
 			float x1 = (w - (float)SDL_DEBUG_TEXT_FONT_CHARACTER_SIZE * strlen(msg1)) / 2.0f;
@@ -434,8 +507,8 @@ void UI_Render(void) {
 			SDL_RenderDebugText(renderer, x1, y_pos, msg1);
 			y_pos += line_height;
 
-			if (stability_timer_start_time > 0) {
-				Uint64 elapsed_ms = (SDL_GetPerformanceCounter() - stability_timer_start_time) * 1000 / SDL_GetPerformanceFrequency();
+			if (ui_view.stability_timer_start_time > 0) {
+				Uint64 elapsed_ms = SDL_NS_TO_MS(Clock_GetTicksNS() - ui_view.stability_timer_start_time);
 				int remaining_secs = (int)((GYRO_STABILITY_DURATION_MS - elapsed_ms) / 1000) + 1;
 				snprintf(buffer, sizeof(buffer), "Keep still for %d more seconds...", remaining_secs > 0 ? remaining_secs : 0);
 			}
@@ -447,19 +520,19 @@ void UI_Render(void) {
 			y_pos += line_height * 1.5f;
 			SDL_RenderDebugText(renderer, x_cancel, y_pos, msg2);
 		}
-		else if (calibration_state == CALIBRATION_SAMPLING) {
-			snprintf(buffer, sizeof(buffer), "GYRO CALIBRATION: SAMPLING... (%d / %d)", calibration_sample_count, CALIBRATION_SAMPLES);
+		else if (ui_view.calibration_state == CALIBRATION_SAMPLING) {
+			snprintf(buffer, sizeof(buffer), "GYRO CALIBRATION: SAMPLING... (%d / %d)", ui_view.calibration_sample_count, CALIBRATION_SAMPLES);
 			RenderStatusMessage(buffer, "Do not move the controller.", "Press (B) on controller to cancel.");
 		}
-		else if (calibration_state == FLICK_STICK_CALIBRATION_START) {
+		else if (ui_view.calibration_state == FLICK_STICK_CALIBRATION_START) {
 			RenderStatusMessage("FLICK STICK CALIBRATION", "Press (A) to perform a test 360 turn.", "Press (B) to cancel.");
 		}
-		else if (calibration_state == FLICK_STICK_CALIBRATION_TURNING) {
+		else if (ui_view.calibration_state == FLICK_STICK_CALIBRATION_TURNING) {
 			RenderStatusMessage(NULL, "TURNING...", NULL);
 		}
-		else if (calibration_state == FLICK_STICK_CALIBRATION_ADJUST) {
+		else if (ui_view.calibration_state == FLICK_STICK_CALIBRATION_ADJUST) {
 			const char* msg1 = "ADJUST CALIBRATION";
-			snprintf(buffer, sizeof(buffer), "Current Value: %.1f", settings.flick_stick_calibration_value);
+			snprintf(buffer, sizeof(buffer), "Current Value: %.1f", ui_view.settings.flick_stick_calibration_value);
 			const char* msg2 = "D-Pad U/D: Fine Tune (+/- 50)";
 			const char* msg3 = "D-Pad L/R: Ultra-Fine Tune (+/- 1)";
 			const char* msg4 = "Shoulders: Coarse Tune (+/- 500)";
@@ -482,46 +555,29 @@ void UI_Render(void) {
 	}
 	else {
 		// --- Draw Main Menu ---
-		BuildVisibleMenu();
-		if (active_menu_label[0] != '\0') {
-			for (int i = 0; i < num_visible_menu_items; ++i) {
-				if (strcmp(menu_items[visible_menu_map[i]].label, active_menu_label) == 0) {
-					selected_menu_item = i; break;
-				}
-			}
-			active_menu_label[0] = '\0';
-		}
-
 		y_pos = 10.0f;
-		char label_buf[128], value_buf[128];
+		char label_buf[128];
 		for (int i = 0; i < num_visible_menu_items; ++i) {
 			int real_idx = visible_menu_map[i];
 			SDL_SetRenderDrawColor(renderer, (i == selected_menu_item) ? 255 : 200, (i == selected_menu_item) ? 255 : 200, (i == selected_menu_item) ? 100 : 255, 255);
 			snprintf(label_buf, sizeof(label_buf), "%s%s", (i == selected_menu_item) ? ">" : " ", menu_items[real_idx].label);
 			SDL_RenderDebugText(renderer, 5.0f, y_pos, label_buf);
-			if (menu_items[real_idx].display) {
-				menu_items[real_idx].display(value_buf, sizeof(value_buf));
-				SDL_RenderDebugText(renderer, 200.0f, y_pos, value_buf);
-			}
+			if (menu_value_cache[i][0] != '\0') SDL_RenderDebugText(renderer, 200.0f, y_pos, menu_value_cache[i]);
 			y_pos += line_height * 1.2f;
 		}
 
 		// --- Gyro Visualizer ---
-		const int cX = w - 55, cY = 55, oR = 50, iR = 5;
-		SDL_SetRenderDrawColor(renderer, settings.flick_stick_enabled ? 255 : 100, 80, 80, 255);
-		DrawCircle(renderer, cX, cY, oR);
-		if (!settings.mouse_mode && settings.anti_deathzone > 0.0f) {
-			SDL_SetRenderDrawColor(renderer, 60, 60, 80, 255);
-			DrawFilledCircle(renderer, cX, cY, (int)(oR * (settings.anti_deathzone / 100.0f)));
+		Visualizer_Draw(renderer, (float)(w - 55), 55.0f, &ui_view.settings, (float)(int)dx, (float)(int)dy, gyro_is_active);
+
+		// --- Telemetry Chart ---
+		if (show_telemetry) {
+			last_telemetry_revision = Telemetry_GetRevision();
+			int count = Telemetry_CopyRecent(telemetry_rows, TELEMETRY_CHART_POINTS);
+			SDL_FRect area = { 5.0f, (float)(h - TELEMETRY_PANEL_HEIGHT + 5), (float)(w - 10), (float)(TELEMETRY_PANEL_HEIGHT - 10) };
+			Visualizer_DrawTelemetry(renderer, &area, telemetry_rows, count);
 		}
-		float dx = gyro_data[1] * 20.f * (settings.invert_gyro_x ? 1.f : -1.f);
-		float dy = -gyro_data[0] * 20.f * (settings.invert_gyro_y ? -1.f : 1.f);
-		float dist = sqrtf(dx * dx + dy * dy);
-		if (dist > oR) { dx = (dx / dist) * oR; dy = (dy / dist) * oR; }
-		bool gyro_is_active = isAiming || settings.always_on_gyro;
-		SDL_SetRenderDrawColor(renderer, gyro_is_active ? 255 : 200, gyro_is_active ? 80 : 200, gyro_is_active ? 80 : 255, 255);
-		DrawFilledCircle(renderer, cX + (int)dx, cY + (int)dy, iR);
 	}
 
 	SDL_RenderPresent(renderer);
+	TRACE_END("UI_Render");
 }
\ No newline at end of file
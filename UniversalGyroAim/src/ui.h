@@ -6,5 +6,6 @@
 void UI_HandleKeyEvent(SDL_Event* event);
 void UI_HandleTextInputEvent(SDL_Event* event);
 void UI_Render(void);
+void UI_Invalidate(void);
 
 #endif
\ No newline at end of file
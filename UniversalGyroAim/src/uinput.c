@@ -0,0 +1,214 @@
+#include "uinput.h"
+#include "output.h"
+#include "trace.h"
+#include "core/core.h"
+
+#ifdef __linux__
+
+#include <linux/uinput.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define UINPUT_MAX_EVENTS 64
+
+static int mouse_fd = -1;
+static int pad_fd = -1;
+static bool is_capturing = false;
+static SDL_Mutex* capture_lock = NULL; // Capturing, the mouse and pad threads share one fd; a frame is written whole
+static XUSB_REPORT last_pad_report;
+
+// --- XUSB buttons as exposed by the Linux xpad driver ---
+static const struct {
+	Uint16 xusb_button;
+	Uint16 key_code;
+} pad_key_map[] = {
+	{ XUSB_GAMEPAD_A, BTN_A },
+	{ XUSB_GAMEPAD_B, BTN_B },
+	{ XUSB_GAMEPAD_X, BTN_X },
+	{ XUSB_GAMEPAD_Y, BTN_Y },
+	{ XUSB_GAMEPAD_LEFT_SHOULDER, BTN_TL },
+	{ XUSB_GAMEPAD_RIGHT_SHOULDER, BTN_TR },
+	{ XUSB_GAMEPAD_BACK, BTN_SELECT },
+	{ XUSB_GAMEPAD_START, BTN_START },
+	{ XUSB_GAMEPAD_GUIDE, BTN_MODE },
+	{ XUSB_GAMEPAD_LEFT_THUMB, BTN_THUMBL },
+	{ XUSB_GAMEPAD_RIGHT_THUMB, BTN_THUMBR }
+};
+
+static void SetupAbsAxis(int fd, Uint16 code, int minimum, int maximum)
+{
+	struct uinput_abs_setup abs_setup = { 0 };
+	abs_setup.code = code;
+	abs_setup.absinfo.minimum = minimum;
+	abs_setup.absinfo.maximum = maximum;
+	ioctl(fd, UI_ABS_SETUP, &abs_setup);
+}
+
+static bool CreateDevice(int fd, const char* name)
+{
+	struct uinput_setup setup = { 0 };
+	setup.id.bustype = BUS_VIRTUAL;
+	setup.id.vendor = VIRTUAL_VENDOR_ID;
+	setup.id.product = VIRTUAL_PRODUCT_ID;
+	SDL_strlcpy(setup.name, name, UINPUT_MAX_NAME_SIZE);
+	return ioctl(fd, UI_DEV_SETUP, &setup) == 0 && ioctl(fd, UI_DEV_CREATE) == 0;
+}
+
+static bool CreateMouseDevice(int fd)
+{
+	ioctl(fd, UI_SET_EVBIT, EV_REL);
+	ioctl(fd, UI_SET_RELBIT, REL_X);
+	ioctl(fd, UI_SET_RELBIT, REL_Y);
+	ioctl(fd, UI_SET_EVBIT, EV_KEY);
+	ioctl(fd, UI_SET_KEYBIT, BTN_LEFT); // Needed for the device to be classified as a pointer
+	return CreateDevice(fd, "Universal Gyro Aim Mouse");
+}
+
+static bool CreatePadDevice(int fd)
+{
+	ioctl(fd, UI_SET_EVBIT, EV_KEY);
+	for (size_t i = 0; i < SDL_arraysize(pad_key_map); ++i) ioctl(fd, UI_SET_KEYBIT, pad_key_map[i].key_code);
+	ioctl(fd, UI_SET_EVBIT, EV_ABS);
+	SetupAbsAxis(fd, ABS_X, -32768, 32767);
+	SetupAbsAxis(fd, ABS_Y, -32768, 32767);
+	SetupAbsAxis(fd, ABS_RX, -32768, 32767);
+	SetupAbsAxis(fd, ABS_RY, -32768, 32767);
+	SetupAbsAxis(fd, ABS_Z, 0, 255);
+	SetupAbsAxis(fd, ABS_RZ, 0, 255);
+	SetupAbsAxis(fd, ABS_HAT0X, -1, 1);
+	SetupAbsAxis(fd, ABS_HAT0Y, -1, 1);
+	return CreateDevice(fd, "Universal Gyro Aim Virtual Pad");
+}
+
+static void QueueEvent(struct input_event* events, int* count, Uint16 type, Uint16 code, Sint32 value)
+{
+	struct input_event* ev = &events[(*count)++];
+	SDL_zerop(ev);
+	ev->type = type;
+	ev->code = code;
+	ev->value = value;
+}
+
+static void WriteEvents(int fd, const struct input_event* events, int count)
+{
+	if (fd < 0 || count == 0) return;
+	if (capture_lock) SDL_LockMutex(capture_lock);
+	ssize_t written = write(fd, events, sizeof(struct input_event) * count);
+	if (capture_lock) SDL_UnlockMutex(capture_lock);
+	if (written < 0) SDL_Log("Warning: uinput write failed.");
+}
+
+// The sub-steps of a batch are summed into one frame with a single SYN_REPORT; splitting a move only helps
+// SendInput, and evdev readers take each frame as one motion anyway.
+static void Uinput_MouseMove(const MouseMove* moves, int count)
+{
+	Sint32 dx = 0, dy = 0;
+	for (int i = 0; i < count; ++i) {
+		dx += moves[i].dx;
+		dy += moves[i].dy;
+	}
+
+	struct input_event events[3];
+	int num_events = 0;
+	if (dx) QueueEvent(events, &num_events, EV_REL, REL_X, dx);
+	if (dy) QueueEvent(events, &num_events, EV_REL, REL_Y, dy);
+	if (num_events == 0) return;
+	QueueEvent(events, &num_events, EV_SYN, SYN_REPORT, 0);
+	WriteEvents(mouse_fd, events, num_events);
+}
+
+// Writes only the fields that changed since the last report, followed by a single SYN_REPORT.
+static void Uinput_PadUpdate(const XUSB_REPORT* report)
+{
+	struct input_event events[UINPUT_MAX_EVENTS];
+	int num_events = 0;
+
+	Uint16 changed_buttons = report->wButtons ^ last_pad_report.wButtons;
+	for (size_t i = 0; i < SDL_arraysize(pad_key_map); ++i) {
+		if (changed_buttons & pad_key_map[i].xusb_button) {
+			QueueEvent(events, &num_events, EV_KEY, pad_key_map[i].key_code, (report->wButtons & pad_key_map[i].xusb_button) ? 1 : 0);
+		}
+	}
+	if (changed_buttons & (XUSB_GAMEPAD_DPAD_LEFT | XUSB_GAMEPAD_DPAD_RIGHT)) {
+		int hat_x = (report->wButtons & XUSB_GAMEPAD_DPAD_RIGHT) ? 1 : ((report->wButtons & XUSB_GAMEPAD_DPAD_LEFT) ? -1 : 0);
+		QueueEvent(events, &num_events, EV_ABS, ABS_HAT0X, hat_x);
+	}
+	if (changed_buttons & (XUSB_GAMEPAD_DPAD_UP | XUSB_GAMEPAD_DPAD_DOWN)) {
+		int hat_y = (report->wButtons & XUSB_GAMEPAD_DPAD_DOWN) ? 1 : ((report->wButtons & XUSB_GAMEPAD_DPAD_UP) ? -1 : 0);
+		QueueEvent(events, &num_events, EV_ABS, ABS_HAT0Y, hat_y);
+	}
+
+	// XUSB sticks are Y-up, evdev axes are Y-down.
+	if (report->sThumbLX != last_pad_report.sThumbLX) QueueEvent(events, &num_events, EV_ABS, ABS_X, report->sThumbLX);
+	if (report->sThumbLY != last_pad_report.sThumbLY) QueueEvent(events, &num_events, EV_ABS, ABS_Y, Core_InvertAxis(report->sThumbLY));
+	if (report->sThumbRX != last_pad_report.sThumbRX) QueueEvent(events, &num_events, EV_ABS, ABS_RX, report->sThumbRX);
+	if (report->sThumbRY != last_pad_report.sThumbRY) QueueEvent(events, &num_events, EV_ABS, ABS_RY, Core_InvertAxis(report->sThumbRY));
+	if (report->bLeftTrigger != last_pad_report.bLeftTrigger) QueueEvent(events, &num_events, EV_ABS, ABS_Z, report->bLeftTrigger);
+	if (report->bRightTrigger != last_pad_report.bRightTrigger) QueueEvent(events, &num_events, EV_ABS, ABS_RZ, report->bRightTrigger);
+
+	if (num_events == 0) return;
+	QueueEvent(events, &num_events, EV_SYN, SYN_REPORT, 0);
+	TRACE_BEGIN("Uinput_PadUpdate");
+	WriteEvents(pad_fd, events, num_events);
+	TRACE_END("Uinput_PadUpdate");
+	last_pad_report = *report;
+}
+
+bool Uinput_Init(const char* capture_path)
+{
+	SDL_zero(last_pad_report);
+
+	if (capture_path && capture_path[0]) {
+		mouse_fd = open(capture_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		capture_lock = SDL_CreateMutex();
+		if (mouse_fd < 0 || !capture_lock) {
+			SDL_Log("Error: Could not open uinput capture file %s.", capture_path);
+			if (mouse_fd >= 0) close(mouse_fd);
+			mouse_fd = -1;
+			if (capture_lock) SDL_DestroyMutex(capture_lock);
+			capture_lock = NULL;
+			uinput_found = false;
+			return false;
+		}
+		pad_fd = mouse_fd;
+		is_capturing = true;
+		SDL_Log("Capturing uinput event stream to %s.", capture_path);
+		uinput_found = true;
+		return true;
+	}
+
+	mouse_fd = open("/dev/uinput", O_WRONLY | O_NONBLOCK);
+	pad_fd = open("/dev/uinput", O_WRONLY | O_NONBLOCK);
+	if (mouse_fd < 0 || pad_fd < 0 || !CreateMouseDevice(mouse_fd) || !CreatePadDevice(pad_fd)) {
+		SDL_Log("Error: Could not create uinput devices. Check write access to /dev/uinput.");
+		Uinput_Shutdown();
+		uinput_found = false;
+		return false;
+	}
+
+	SDL_Log("Virtual uinput mouse and gamepad are active.");
+	uinput_found = true;
+	return true;
+}
+
+void Uinput_Shutdown(void)
+{
+	if (is_capturing) {
+		close(mouse_fd);
+		SDL_DestroyMutex(capture_lock);
+		capture_lock = NULL;
+	}
+	else {
+		if (mouse_fd >= 0) { ioctl(mouse_fd, UI_DEV_DESTROY); close(mouse_fd); }
+		if (pad_fd >= 0) { ioctl(pad_fd, UI_DEV_DESTROY); close(pad_fd); }
+	}
+	mouse_fd = -1;
+	pad_fd = -1;
+	is_capturing = false;
+	uinput_found = false;
+}
+
+const OutputSink uinput_sink = { "uinput", Uinput_MouseMove, Uinput_PadUpdate };
+
+#endif
\ No newline at end of file
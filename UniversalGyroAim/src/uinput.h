@@ -0,0 +1,11 @@
+#ifndef UINPUT_H
+#define UINPUT_H
+
+#include "state.h"
+
+// Linux output backend. With a capture path, the raw input_event stream is written to that file or pipe
+// instead of creating devices through /dev/uinput.
+bool Uinput_Init(const char* capture_path);
+void Uinput_Shutdown(void);
+
+#endif
\ No newline at end of file
@@ -1,4 +1,8 @@
 #include "vigem.h"
+#include "output.h"
+#include "trace.h"
+
+#ifdef _WIN32
 
 bool Vigem_Init(void) {
 	vigem_client = vigem_alloc();
@@ -44,8 +48,14 @@ void Vigem_Shutdown(void) {
 	}
 }
 
-void Vigem_Update(XUSB_REPORT report) {
+void Vigem_Update(const XUSB_REPORT* report) {
 	if (vigem_found && x360_pad && vigem_client) {
-		vigem_target_x360_update(vigem_client, x360_pad, report);
+		TRACE_BEGIN("Vigem_Update");
+		vigem_target_x360_update(vigem_client, x360_pad, *report);
+		TRACE_END("Vigem_Update");
 	}
-}
\ No newline at end of file
+}
+
+const OutputSink vigem_sink = { "ViGEm", NULL, Vigem_Update };
+
+#endif
\ No newline at end of file
@@ -5,6 +5,6 @@
 
 bool Vigem_Init(void);
 void Vigem_Shutdown(void);
-void Vigem_Update(XUSB_REPORT report);
+void Vigem_Update(const XUSB_REPORT* report);
 
 #endif
\ No newline at end of file
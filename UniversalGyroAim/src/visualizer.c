@@ -0,0 +1,226 @@
+#include "visualizer.h"
+#include <math.h>
+#include <stdio.h>
+
+#define LAYER_SIZE (VISUALIZER_OUTER_RADIUS * 2 + 1)
+
+static SDL_Texture* static_layer = NULL;
+static bool static_layer_flick_stick = false;
+static int static_layer_disc_radius = -1; // -1 = layer not drawn yet
+
+static SDL_FPoint dot_outline[VISUALIZER_DOT_SEGMENTS]; // Unit circle, filled on first use
+static bool dot_outline_ready = false;
+
+// Midpoint circle, collected into one SDL_RenderPoints batch.
+static void DrawCircle(SDL_Renderer* renderer, int centreX, int centreY, int radius) {
+	SDL_FPoint points[8 * VISUALIZER_OUTER_RADIUS];
+	int count = 0;
+	const int32_t diameter = (radius * 2);
+	int32_t x = (radius - 1); int32_t y = 0; int32_t tx = 1; int32_t ty = 1; int32_t error = (tx - diameter);
+	while (x >= y && count + 8 <= (int)SDL_arraysize(points)) {
+		points[count++] = (SDL_FPoint){ (float)(centreX + x), (float)(centreY - y) }; points[count++] = (SDL_FPoint){ (float)(centreX + x), (float)(centreY + y) };
+		points[count++] = (SDL_FPoint){ (float)(centreX - x), (float)(centreY - y) }; points[count++] = (SDL_FPoint){ (float)(centreX - x), (float)(centreY + y) };
+		points[count++] = (SDL_FPoint){ (float)(centreX + y), (float)(centreY - x) }; points[count++] = (SDL_FPoint){ (float)(centreX + y), (float)(centreY + x) };
+		points[count++] = (SDL_FPoint){ (float)(centreX - y), (float)(centreY - x) }; points[count++] = (SDL_FPoint){ (float)(centreX - y), (float)(centreY + x) };
+		if (error <= 0) { ++y; error += ty; ty += 2; }
+		if (error > 0) { --x; tx += 2; error += (tx - diameter); }
+	}
+	SDL_RenderPoints(renderer, points, count);
+}
+
+// Midpoint disc as one-pixel-high scanlines, collected into one SDL_RenderFillRects batch.
+static void DrawFilledCircle(SDL_Renderer* renderer, int x, int y, int radius)
+{
+	SDL_FRect rects[4 * VISUALIZER_OUTER_RADIUS];
+	int count = 0;
+	int offsetx, offsety, d;
+	offsetx = 0; offsety = radius; d = radius - 1;
+	while (offsety >= offsetx && count + 4 <= (int)SDL_arraysize(rects)) {
+		rects[count++] = (SDL_FRect){ (float)(x - offsety), (float)(y + offsetx), (float)(2 * offsety + 1), 1.0f };
+		rects[count++] = (SDL_FRect){ (float)(x - offsetx), (float)(y + offsety), (float)(2 * offsetx + 1), 1.0f };
+		rects[count++] = (SDL_FRect){ (float)(x - offsetx), (float)(y - offsety), (float)(2 * offsetx + 1), 1.0f };
+		rects[count++] = (SDL_FRect){ (float)(x - offsety), (float)(y - offsetx), (float)(2 * offsety + 1), 1.0f };
+		if (d >= 2 * offsetx) {
+			d -= 2 * offsetx + 1; offsetx++;
+		}
+		else if (d < 2 * (radius - offsety)) {
+			d += 2 * offsety - 1; offsety--;
+		}
+		else { d += 2 * (offsety - offsetx - 1); offsety--; offsetx++; }
+	}
+	SDL_RenderFillRects(renderer, rects, count);
+}
+
+static int DrawStaticLayer(SDL_Renderer* renderer, int centreX, int centreY, bool flick_stick, int disc_radius)
+{
+	SDL_SetRenderDrawColor(renderer, flick_stick ? 255 : 100, 80, 80, 255);
+	DrawCircle(renderer, centreX, centreY, VISUALIZER_OUTER_RADIUS);
+	if (disc_radius <= 0) return 1;
+	SDL_SetRenderDrawColor(renderer, 60, 60, 80, 255);
+	DrawFilledCircle(renderer, centreX, centreY, disc_radius);
+	return 2;
+}
+
+static bool RebuildStaticLayer(SDL_Renderer* renderer, bool flick_stick, int disc_radius)
+{
+	if (!static_layer) {
+		static_layer = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, LAYER_SIZE, LAYER_SIZE);
+		if (!static_layer) {
+			SDL_Log("Warning: Could not create visualizer texture, drawing it directly: %s", SDL_GetError());
+			return false;
+		}
+		SDL_SetTextureBlendMode(static_layer, SDL_BLENDMODE_BLEND);
+	}
+
+	SDL_Texture* previous_target = SDL_GetRenderTarget(renderer);
+	if (!SDL_SetRenderTarget(renderer, static_layer)) return false;
+	SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+	SDL_RenderClear(renderer);
+	DrawStaticLayer(renderer, VISUALIZER_OUTER_RADIUS, VISUALIZER_OUTER_RADIUS, flick_stick, disc_radius);
+	SDL_SetRenderTarget(renderer, previous_target);
+
+	static_layer_flick_stick = flick_stick;
+	static_layer_disc_radius = disc_radius;
+	return true;
+}
+
+// The dot as a triangle fan in a single SDL_RenderGeometry call.
+static void DrawDot(SDL_Renderer* renderer, float centre_x, float centre_y, bool gyro_is_active)
+{
+	if (!dot_outline_ready) {
+		for (int i = 0; i < VISUALIZER_DOT_SEGMENTS; ++i) {
+			float angle = (float)i * 2.0f * SDL_PI_F / VISUALIZER_DOT_SEGMENTS;
+			dot_outline[i] = (SDL_FPoint){ cosf(angle), sinf(angle) };
+		}
+		dot_outline_ready = true;
+	}
+
+	const SDL_FColor color = gyro_is_active ? (SDL_FColor){ 1.0f, 80 / 255.0f, 80 / 255.0f, 1.0f } : (SDL_FColor){ 200 / 255.0f, 200 / 255.0f, 1.0f, 1.0f };
+	SDL_Vertex vertices[VISUALIZER_DOT_SEGMENTS + 1];
+	int indices[VISUALIZER_DOT_SEGMENTS * 3];
+	vertices[0] = (SDL_Vertex){ { centre_x, centre_y }, color, { 0.0f, 0.0f } };
+	for (int i = 0; i < VISUALIZER_DOT_SEGMENTS; ++i) {
+		vertices[i + 1] = (SDL_Vertex){ { centre_x + dot_outline[i].x * VISUALIZER_DOT_RADIUS, centre_y + dot_outline[i].y * VISUALIZER_DOT_RADIUS }, color, { 0.0f, 0.0f } };
+		indices[i * 3] = 0;
+		indices[i * 3 + 1] = i + 1;
+		indices[i * 3 + 2] = (i + 1) % VISUALIZER_DOT_SEGMENTS + 1;
+	}
+	SDL_RenderGeometry(renderer, NULL, vertices, SDL_arraysize(vertices), indices, SDL_arraysize(indices));
+}
+
+// --- Telemetry chart ---
+enum { LANE_GYRO, LANE_MOUSE, LANE_INTERVAL, LANE_LATENCY, LANE_COUNT };
+
+static const struct {
+	const char* label;
+	bool is_signed; // Zero in the middle of the lane rather than at the bottom
+	float min_range; // Smallest full-scale value, so noise is not blown up to the lane height
+} chart_lanes[LANE_COUNT] = {
+	{ "gyro rad/s",   true,  1.0f },
+	{ "mouse counts", true,  4.0f },
+	{ "interval ms",  false, 5.0f },
+	{ "latency ms",   false, 2.0f },
+};
+
+static const struct {
+	int lane;
+	Uint8 r, g, b;
+} chart_series[] = {
+	{ LANE_GYRO,     255, 100, 100 }, // Pitch
+	{ LANE_GYRO,     100, 255, 100 }, // Yaw
+	{ LANE_GYRO,     100, 150, 255 }, // Roll
+	{ LANE_MOUSE,    255, 200, 100 }, // X
+	{ LANE_MOUSE,    200, 100, 255 }, // Y
+	{ LANE_INTERVAL, 200, 200, 200 },
+	{ LANE_LATENCY,  255, 255, 100 },
+};
+
+static float ChartValue(const TelemetrySample* row, int series)
+{
+	switch (series) {
+	case 0: case 1: case 2: return row->gyro_rate[series];
+	case 3: case 4: return row->mouse_counts[series - 3];
+	case 5: return row->sample_interval_ms;
+	default: return row->latency_ms;
+	}
+}
+
+int Visualizer_DrawTelemetry(SDL_Renderer* renderer, const SDL_FRect* area, const TelemetrySample* rows, int count)
+{
+	const float lane_height = area->h / LANE_COUNT;
+	int draw_calls = 0;
+
+	// Each lane scales to the largest magnitude currently on screen.
+	float range[LANE_COUNT];
+	for (int lane = 0; lane < LANE_COUNT; ++lane) range[lane] = chart_lanes[lane].min_range;
+	for (int series = 0; series < (int)SDL_arraysize(chart_series); ++series) {
+		float* lane_range = &range[chart_series[series].lane];
+		for (int i = 0; i < count; ++i) {
+			float magnitude = fabsf(ChartValue(&rows[i], series));
+			if (magnitude > *lane_range) *lane_range = magnitude;
+		}
+	}
+
+	SDL_FRect frames[LANE_COUNT];
+	for (int lane = 0; lane < LANE_COUNT; ++lane) frames[lane] = (SDL_FRect){ area->x, area->y + lane * lane_height, area->w, lane_height };
+	SDL_SetRenderDrawColor(renderer, 60, 60, 80, 255);
+	SDL_RenderRects(renderer, frames, LANE_COUNT);
+	draw_calls++;
+
+	SDL_SetRenderDrawColor(renderer, 150, 150, 170, 255);
+	for (int lane = 0; lane < LANE_COUNT; ++lane) {
+		char label[64];
+		snprintf(label, sizeof(label), chart_lanes[lane].is_signed ? "%s +/-%.1f" : "%s %.1f", chart_lanes[lane].label, range[lane]);
+		SDL_RenderDebugText(renderer, area->x + 3.0f, frames[lane].y + 2.0f, label);
+		draw_calls++;
+	}
+	if (count < 2) return draw_calls;
+
+	// Newest sample at the right edge; a partly filled history starts part way across.
+	SDL_FPoint points[TELEMETRY_CHART_POINTS];
+	if (count > TELEMETRY_CHART_POINTS) { rows += count - TELEMETRY_CHART_POINTS; count = TELEMETRY_CHART_POINTS; }
+	const float step = area->w / (TELEMETRY_CHART_POINTS - 1);
+	const float x_start = area->x + area->w - step * (count - 1);
+	for (int series = 0; series < (int)SDL_arraysize(chart_series); ++series) {
+		int lane = chart_series[series].lane;
+		float half_height = (lane_height - 2.0f) * (chart_lanes[lane].is_signed ? 0.5f : 1.0f);
+		float baseline = chart_lanes[lane].is_signed ? frames[lane].y + lane_height * 0.5f : frames[lane].y + lane_height - 1.0f;
+		for (int i = 0; i < count; ++i) {
+			points[i].x = x_start + step * i;
+			points[i].y = baseline - ChartValue(&rows[i], series) / range[lane] * half_height;
+		}
+		SDL_SetRenderDrawColor(renderer, chart_series[series].r, chart_series[series].g, chart_series[series].b, 255);
+		SDL_RenderLines(renderer, points, count);
+		draw_calls++;
+	}
+	return draw_calls;
+}
+
+int Visualizer_Draw(SDL_Renderer* renderer, float centre_x, float centre_y, const AppSettings* s, float dot_x, float dot_y, bool gyro_is_active)
+{
+	int draw_calls = 0;
+	int disc_radius = (!s->mouse_mode && s->anti_deathzone > 0.0f) ? (int)(VISUALIZER_OUTER_RADIUS * (s->anti_deathzone / 100.0f)) : 0;
+	bool layer_is_current = static_layer && static_layer_disc_radius == disc_radius && static_layer_flick_stick == s->flick_stick_enabled;
+	if (!layer_is_current) layer_is_current = RebuildStaticLayer(renderer, s->flick_stick_enabled, disc_radius);
+
+	if (layer_is_current) {
+		SDL_FRect dst = { centre_x - VISUALIZER_OUTER_RADIUS, centre_y - VISUALIZER_OUTER_RADIUS, (float)LAYER_SIZE, (float)LAYER_SIZE };
+		SDL_RenderTexture(renderer, static_layer, NULL, &dst);
+		draw_calls++;
+	}
+	else {
+		draw_calls += DrawStaticLayer(renderer, (int)centre_x, (int)centre_y, s->flick_stick_enabled, disc_radius);
+	}
+
+	DrawDot(renderer, centre_x + dot_x, centre_y + dot_y, gyro_is_active);
+	return draw_calls + 1;
+}
+
+void Visualizer_Destroy(void)
+{
+	if (static_layer) {
+		SDL_DestroyTexture(static_layer);
+		static_layer = NULL;
+	}
+	static_layer_disc_radius = -1;
+}
\ No newline at end of file
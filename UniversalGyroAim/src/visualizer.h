@@ -0,0 +1,20 @@
+#ifndef VISUALIZER_H
+#define VISUALIZER_H
+
+#include "state.h"
+
+#define VISUALIZER_OUTER_RADIUS 50
+#define VISUALIZER_DOT_RADIUS 5
+#define VISUALIZER_DOT_SEGMENTS 16
+
+// Gyro visualizer. The ring and anti-deadzone disc are cached in a texture that is only redrawn when the
+// settings they depend on change; the moving dot is the only per-frame geometry.
+// Returns the number of render calls issued.
+int Visualizer_Draw(SDL_Renderer* renderer, float centre_x, float centre_y, const AppSettings* s, float dot_x, float dot_y, bool gyro_is_active);
+// Telemetry strip chart: gyro rate, mouse counts, sample interval and latency lanes, one line batch per series.
+// Returns the number of render calls issued.
+int Visualizer_DrawTelemetry(SDL_Renderer* renderer, const SDL_FRect* area, const TelemetrySample* rows, int count);
+// Frees the cached layer; it is recreated on the next draw. Also call this when the renderer loses its targets.
+void Visualizer_Destroy(void);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,67 @@
+#include "wakeup.h"
+
+#ifdef _WIN32
+
+bool Wakeup_Init(Wakeup* wakeup)
+{
+	wakeup->handle = CreateEventW(NULL, FALSE, FALSE, NULL); // Auto-reset: one wait consumes any number of signals
+	return wakeup->handle != NULL;
+}
+
+void Wakeup_Destroy(Wakeup* wakeup)
+{
+	if (wakeup->handle) {
+		CloseHandle(wakeup->handle);
+		wakeup->handle = NULL;
+	}
+}
+
+void Wakeup_Signal(Wakeup* wakeup)
+{
+	if (wakeup->handle) SetEvent(wakeup->handle);
+}
+
+bool Wakeup_Wait(Wakeup* wakeup, Sint32 timeout_ms)
+{
+	return WaitForSingleObject(wakeup->handle, (timeout_ms < 0) ? INFINITE : (DWORD)timeout_ms) == WAIT_OBJECT_0;
+}
+
+#else
+
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <unistd.h>
+#include <stdint.h>
+
+bool Wakeup_Init(Wakeup* wakeup)
+{
+	wakeup->fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	return wakeup->fd >= 0;
+}
+
+void Wakeup_Destroy(Wakeup* wakeup)
+{
+	if (wakeup->fd >= 0) {
+		close(wakeup->fd);
+		wakeup->fd = -1;
+	}
+}
+
+void Wakeup_Signal(Wakeup* wakeup)
+{
+	if (wakeup->fd < 0) return;
+	uint64_t one = 1;
+	ssize_t written = write(wakeup->fd, &one, sizeof(one));
+	(void)written; // EAGAIN means the counter is already saturated, i.e. already signaled
+}
+
+bool Wakeup_Wait(Wakeup* wakeup, Sint32 timeout_ms)
+{
+	struct pollfd pfd = { wakeup->fd, POLLIN, 0 };
+	if (poll(&pfd, 1, (timeout_ms < 0) ? -1 : timeout_ms) <= 0) return false;
+
+	uint64_t count;
+	return read(wakeup->fd, &count, sizeof(count)) == sizeof(count); // Resets the counter
+}
+
+#endif
\ No newline at end of file
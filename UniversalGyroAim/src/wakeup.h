@@ -0,0 +1,11 @@
+#ifndef WAKEUP_H
+#define WAKEUP_H
+
+#include "state.h"
+
+bool Wakeup_Init(Wakeup* wakeup);
+void Wakeup_Destroy(Wakeup* wakeup);
+void Wakeup_Signal(Wakeup* wakeup);
+bool Wakeup_Wait(Wakeup* wakeup, Sint32 timeout_ms); // timeout_ms < 0 waits forever; returns true if signaled
+
+#endif
\ No newline at end of file
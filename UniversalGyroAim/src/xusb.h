@@ -0,0 +1,35 @@
+#ifndef XUSB_H
+#define XUSB_H
+
+// XInput-compatible report layout, matching ViGEmCommon.h, for platforms without the ViGEm client.
+#include <SDL3/SDL.h>
+
+typedef enum {
+	XUSB_GAMEPAD_DPAD_UP = 0x0001,
+	XUSB_GAMEPAD_DPAD_DOWN = 0x0002,
+	XUSB_GAMEPAD_DPAD_LEFT = 0x0004,
+	XUSB_GAMEPAD_DPAD_RIGHT = 0x0008,
+	XUSB_GAMEPAD_START = 0x0010,
+	XUSB_GAMEPAD_BACK = 0x0020,
+	XUSB_GAMEPAD_LEFT_THUMB = 0x0040,
+	XUSB_GAMEPAD_RIGHT_THUMB = 0x0080,
+	XUSB_GAMEPAD_LEFT_SHOULDER = 0x0100,
+	XUSB_GAMEPAD_RIGHT_SHOULDER = 0x0200,
+	XUSB_GAMEPAD_GUIDE = 0x0400,
+	XUSB_GAMEPAD_A = 0x1000,
+	XUSB_GAMEPAD_B = 0x2000,
+	XUSB_GAMEPAD_X = 0x4000,
+	XUSB_GAMEPAD_Y = 0x8000
+} XUSB_BUTTON;
+
+typedef struct {
+	Uint16 wButtons;
+	Uint8 bLeftTrigger;
+	Uint8 bRightTrigger;
+	Sint16 sThumbLX;
+	Sint16 sThumbLY;
+	Sint16 sThumbRX;
+	Sint16 sThumbRY;
+} XUSB_REPORT;
+
+#endif
\ No newline at end of file